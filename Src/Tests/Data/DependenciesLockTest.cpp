@@ -0,0 +1,102 @@
+#include "runcpp2/Data/DependenciesLock.hpp"
+#include "runcpp2/LibYAML_Wrapper.hpp"
+#include "runcpp2/runcpp2.hpp"
+#include "runcpp2/DeferUtil.hpp"
+#include "ssLogger/ssLog.hpp"
+
+DS::Result<void> TestMain()
+{
+    //DependenciesLock Should Parse Revisions
+    {
+        //NOTE: This is just a test YAML for validating parsing, don't use it for actual config
+        const char* yamlStr = R"(
+            #Generated by runcpp2, use `runcpp2 lock` to update the revisions
+            Revisions:
+                "GitDependency":
+                    Source: "https://github.com/user/repo.git#main"
+                    Revision: "0123456789abcdef0123456789abcdef01234567"
+                "ArchiveDependency":
+                    Source: "./Archive.tar.gz"
+                    Revision: "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"
+        )";
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = runcpp2::YAML::ParseYAML(   yamlStr, 
+                                                                                resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependenciesLock lock;
+        DS_ASSERT_TRUE(lock.ParseYAML_Node(roots.front()));
+        
+        //Verify parsed values
+        DS_ASSERT_EQ(lock.Revisions.size(), 2);
+        DS_ASSERT_EQ(   lock.Revisions.at("GitDependency").Source, 
+                        "https://github.com/user/repo.git#main");
+        DS_ASSERT_EQ(   lock.Revisions.at("GitDependency").Revision, 
+                        "0123456789abcdef0123456789abcdef01234567");
+        DS_ASSERT_EQ(lock.Revisions.at("ArchiveDependency").Source, "./Archive.tar.gz");
+        DS_ASSERT_EQ(   lock.Revisions.at("ArchiveDependency").Revision, 
+                        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        
+        //Test ToString() and Equals()
+        std::string yamlOutput = lock.ToString("");
+        roots = runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
+        DS_ASSERT_EQ(roots.size(), 1);
+        
+        runcpp2::Data::DependenciesLock parsedOutput;
+        DS_ASSERT_TRUE(parsedOutput.ParseYAML_Node(roots.front()));
+        DS_ASSERT_TRUE(lock.Equals(parsedOutput));
+    }
+    
+    //DependenciesLock Should Fail To Parse Revisions Without Source
+    {
+        const char* yamlStr = R"(
+            Revisions:
+                "GitDependency": "0123456789abcdef0123456789abcdef01234567"
+        )";
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = runcpp2::YAML::ParseYAML(   yamlStr, 
+                                                                                resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependenciesLock lock;
+        DS_ASSERT_FALSE(lock.ParseYAML_Node(roots.front()));
+    }
+    
+    //DependenciesLock Should Parse Empty Revisions
+    {
+        runcpp2::Data::DependenciesLock lock;
+        std::string yamlOutput = lock.ToString("");
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = 
+            runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependenciesLock parsedOutput;
+        DS_ASSERT_TRUE(parsedOutput.ParseYAML_Node(roots.front()));
+        DS_ASSERT_TRUE(parsedOutput.Revisions.empty());
+        DS_ASSERT_TRUE(lock.Equals(parsedOutput));
+    }
+    
+    return {};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TestMain().DS_TRY_ACT(ssLOG_LINE(DS_TMP_ERROR.ToString()); return 1);
+        return 0;
+    }
+    catch(std::exception& ex)
+    {
+        ssLOG_LINE(ex.what());
+        return 1;
+    }
+    return 1;
+}
@@ -68,6 +68,8 @@ DS::Result<void> TestMain()
                 Unix:
                     GCC:
                     -   lib/libmylib.so
+            DependsOn:
+            -   ImageCodec
         )";
     
         runcpp2::YAML::ResourceHandle resource;
@@ -117,6 +119,10 @@ DS::Result<void> TestMain()
         DS_ASSERT_EQ(msvcDebugFiles.size(), 2);
         DS_ASSERT_EQ(msvcDebugFiles.at(0), "bin/Debug/mylib.dll");
         
+        //Verify DependsOn
+        DS_ASSERT_EQ(dependencyInfo.DependsOn.size(), 1);
+        DS_ASSERT_EQ(dependencyInfo.DependsOn.at(0), "ImageCodec");
+        
         //Test ToString() and Equals()
         std::string yamlOutput = dependencyInfo.ToString("");
         roots = runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
@@ -184,6 +190,44 @@ DS::Result<void> TestMain()
     
     }
     
+    //GetDependenciesWaves Should Order Dependencies By DependsOn
+    {
+        runcpp2::Data::DependencyInfo zlib;
+        zlib.Name = "zlib";
+        
+        runcpp2::Data::DependencyInfo png;
+        png.Name = "png";
+        png.DependsOn = { "zlib" };
+        
+        runcpp2::Data::DependencyInfo imageCodec;
+        imageCodec.Name = "ImageCodec";
+        imageCodec.DependsOn = { "png", "zlib", "NotAvailable" };
+        
+        runcpp2::Data::DependencyInfo json;
+        json.Name = "json";
+        
+        std::vector<const runcpp2::Data::DependencyInfo*> dependencies = 
+        {
+            &imageCodec, &png, &zlib, &json
+        };
+        
+        std::vector<std::vector<int>> waves;
+        runcpp2::Data::GetDependenciesWaves(dependencies, waves).DS_TRY();
+        
+        DS_ASSERT_EQ(waves.size(), 3);
+        DS_ASSERT_EQ(waves.at(0).size(), 2);
+        DS_ASSERT_EQ(waves.at(0).at(0), 2);
+        DS_ASSERT_EQ(waves.at(0).at(1), 3);
+        DS_ASSERT_EQ(waves.at(1).size(), 1);
+        DS_ASSERT_EQ(waves.at(1).at(0), 1);
+        DS_ASSERT_EQ(waves.at(2).size(), 1);
+        DS_ASSERT_EQ(waves.at(2).at(0), 0);
+        
+        //Cyclic DependsOn should fail
+        zlib.DependsOn = { "ImageCodec" };
+        DS_ASSERT_FALSE(runcpp2::Data::GetDependenciesWaves(dependencies, waves).HasValue());
+    }
+    
     return {};
 }
 
@@ -0,0 +1,81 @@
+#include "runcpp2/Data/DependencyReadyRecord.hpp"
+#include "runcpp2/LibYAML_Wrapper.hpp"
+#include "runcpp2/runcpp2.hpp"
+#include "runcpp2/DeferUtil.hpp"
+#include "ssLogger/ssLog.hpp"
+
+DS::Result<void> TestMain()
+{
+    //DependencyReadyRecord Should Parse Valid YAML
+    {
+        //NOTE: This is just a test YAML for validating parsing, don't use it for actual config
+        const char* yamlStr = R"(
+            Key: "1234567890"
+            Revision: "0123456789abcdef0123456789abcdef01234567"
+            BinariesPaths:
+            -   "/tmp/Build/MyLibrary/build/libMyLibrary.a"
+            -   "/tmp/Build/MyLibrary/build/libMyLibrary.so"
+        )";
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = runcpp2::YAML::ParseYAML(   yamlStr, 
+                                                                                resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependencyReadyRecord record;
+        DS_ASSERT_TRUE(record.ParseYAML_Node(roots.front()));
+        
+        //Verify parsed values
+        DS_ASSERT_EQ(record.Key, "1234567890");
+        DS_ASSERT_EQ(record.Revision, "0123456789abcdef0123456789abcdef01234567");
+        DS_ASSERT_EQ(record.BinariesPaths.size(), 2);
+        DS_ASSERT_EQ(record.BinariesPaths.at(0), "/tmp/Build/MyLibrary/build/libMyLibrary.a");
+        DS_ASSERT_EQ(record.BinariesPaths.at(1), "/tmp/Build/MyLibrary/build/libMyLibrary.so");
+        
+        //Test ToString() and Equals()
+        std::string yamlOutput = record.ToString("");
+        roots = runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
+        DS_ASSERT_EQ(roots.size(), 1);
+        
+        runcpp2::Data::DependencyReadyRecord parsedOutput;
+        DS_ASSERT_TRUE(parsedOutput.ParseYAML_Node(roots.front()));
+        DS_ASSERT_TRUE(record.Equals(parsedOutput));
+    }
+    
+    //DependencyReadyRecord Should Parse Empty Binaries
+    {
+        runcpp2::Data::DependencyReadyRecord record;
+        record.Key = "1234567890";
+        record.Revision = "0123456789abcdef0123456789abcdef01234567";
+        std::string yamlOutput = record.ToString("");
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = 
+            runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependencyReadyRecord parsedOutput;
+        DS_ASSERT_TRUE(parsedOutput.ParseYAML_Node(roots.front()));
+        DS_ASSERT_TRUE(parsedOutput.BinariesPaths.empty());
+        DS_ASSERT_TRUE(record.Equals(parsedOutput));
+    }
+    
+    return {};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TestMain().DS_TRY_ACT(ssLOG_LINE(DS_TMP_ERROR.ToString()); return 1);
+        return 0;
+    }
+    catch(std::exception& ex)
+    {
+        ssLOG_LINE(ex.what());
+        return 1;
+    }
+    return 1;
+}
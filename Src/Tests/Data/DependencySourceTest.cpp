@@ -15,6 +15,9 @@ DS::Result<void> TestMain()
                 Branch: master
                 FullHistory: true
                 SubmoduleInitType: Full
+                PartialClone: true
+                SparseCheckout: true
+                SparseCheckoutPaths: ["build", "cmake"]
         )";
         
         runcpp2::YAML::ResourceHandle resource;
@@ -37,6 +40,11 @@ DS::Result<void> TestMain()
         DS_ASSERT_EQ(git->Branch, "master");
         DS_ASSERT_TRUE(git->FullHistory);
         DS_ASSERT_EQ((int)git->CurrentSubmoduleInitType, (int)runcpp2::Data::SubmoduleInitType::FULL);
+        DS_ASSERT_TRUE(git->PartialClone);
+        DS_ASSERT_TRUE(git->SparseCheckout);
+        DS_ASSERT_EQ(git->SparseCheckoutPaths.size(), 2);
+        DS_ASSERT_EQ(git->SparseCheckoutPaths.at(0), "build");
+        DS_ASSERT_EQ(git->SparseCheckoutPaths.at(1), "cmake");
         
         //Test ToString() and Equals()
         std::string yamlOutput = dependencySource.ToString("");
@@ -82,6 +90,64 @@ DS::Result<void> TestMain()
         DS_ASSERT_TRUE(dependencySource.Equals(parsedOutput));
     }
     
+    //DependencySource Should Parse Archive Source
+    {
+        //NOTE: This is just a test YAML for validating parsing, don't use it for actual config
+        const char* yamlStr = R"(
+            Archive:
+                Path: file:///opt/archives/mylib-1.0.tar.gz
+                SHA256: 9F86D081884C7D659A2FEAA0C55AD015A3BF4F1B2B0B822CD15D6C15B0F00A08
+                CopyMode: Copy
+        )";
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = runcpp2::YAML::ParseYAML(   yamlStr, 
+                                                                                resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::YAML::NodePtr root = roots.front();
+        runcpp2::Data::DependencySource dependencySource;
+        DS_ASSERT_TRUE(dependencySource.ParseYAML_Node(root));
+        
+        //Verify parsed values
+        const runcpp2::Data::ArchiveSource* archive = 
+            mpark::get_if<runcpp2::Data::ArchiveSource>(&dependencySource.Source);
+        DS_ASSERT_TRUE(archive != nullptr);
+        DS_ASSERT_EQ(archive->Path, "file:///opt/archives/mylib-1.0.tar.gz");
+        DS_ASSERT_EQ(   archive->SHA256, 
+                        "9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08");
+        DS_ASSERT_EQ((int)archive->CopyMode, (int)runcpp2::Data::LocalCopyMode::Copy);
+        
+        //Test ToString() and Equals()
+        std::string yamlOutput = dependencySource.ToString("");
+        roots = runcpp2::YAML::ParseYAML(yamlOutput, resource).DS_TRY();
+        DS_ASSERT_EQ(roots.size(), 1);
+        
+        runcpp2::Data::DependencySource parsedOutput;
+        parsedOutput.ParseYAML_Node(roots.front());
+        DS_ASSERT_TRUE(dependencySource.Equals(parsedOutput));
+    }
+    
+    //DependencySource Should Fail With Multiple Sources
+    {
+        //NOTE: This is just a test YAML for validating parsing, don't use it for actual config
+        const char* yamlStr = R"(
+            Local:
+                Path: ../external/mylib
+            Archive:
+                Path: ../external/mylib.zip
+                SHA256: 9f86d081884c7d659a2feaa0c55ad015a3bf4f1b2b0b822cd15d6c15b0f00a08
+        )";
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> roots = runcpp2::YAML::ParseYAML(   yamlStr, 
+                                                                                resource).DS_TRY();
+        DEFER { FreeYAMLResource(resource); };
+        DS_ASSERT_EQ(roots.size(), 1);
+        runcpp2::Data::DependencySource dependencySource;
+        DS_ASSERT_FALSE(dependencySource.ParseYAML_Node(roots.front()));
+    }
+    
     return {};
 }
 
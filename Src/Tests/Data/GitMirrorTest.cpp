@@ -0,0 +1,128 @@
+#include "runcpp2/runcpp2.hpp"
+#include "runcpp2/DeferUtil.hpp"
+#include "ssLogger/ssLog.hpp"
+
+#include <fstream>
+#include <string>
+
+bool RunTestCommand(const std::string& command, const ghc::filesystem::path& runDirectory)
+{
+    std::string output;
+    int returnCode = 0;
+    if(!runcpp2::RunCommand(command, true, runDirectory.string(), output, returnCode))
+    {
+        ssLOG_LINE("Failed to run " << command << " with result " << returnCode << ":\n" << output);
+        return false;
+    }
+    return true;
+}
+
+int GetMirrorsCount(const ghc::filesystem::path& mirrorsDir)
+{
+    std::error_code e;
+    int mirrorsCount = 0;
+    for(ghc::filesystem::directory_iterator it(mirrorsDir, e);
+        !e && it != ghc::filesystem::directory_iterator();
+        it.increment(e))
+    {
+        if(it->path().extension() == ".git")
+            ++mirrorsCount;
+    }
+    return mirrorsCount;
+}
+
+DS::Result<void> TestMain()
+{
+    std::error_code e;
+    const ghc::filesystem::path testDir = ghc::filesystem::absolute("./GitMirrorTestFiles", e);
+    const ghc::filesystem::path repoPath = testDir / "Repository";
+    const ghc::filesystem::path mirrorsDir = testDir / "GitMirrors";
+    ghc::filesystem::remove_all(testDir, e);
+    DS_ASSERT_TRUE(ghc::filesystem::create_directories(repoPath, e));
+    DS_ASSERT_TRUE(ghc::filesystem::create_directories(mirrorsDir, e));
+    DEFER { ghc::filesystem::remove_all(testDir, e); };
+    
+    //Create a local repository to clone from
+    {
+        std::ofstream headerFile((repoPath / "Test.hpp").string());
+        DS_ASSERT_TRUE(headerFile.is_open());
+        headerFile << "#define TEST_VALUE 1\n";
+    }
+    DS_ASSERT_TRUE(RunTestCommand("git init", repoPath));
+    DS_ASSERT_TRUE(RunTestCommand("git add Test.hpp", repoPath));
+    DS_ASSERT_TRUE(RunTestCommand(  "git -c user.name=runcpp2 -c user.email=runcpp2@localhost "
+                                    "-c commit.gpgsign=false commit -m Initial",
+                                    repoPath));
+    
+    runcpp2::Data::GitSource git;
+    git.URL = "file://" +
+              std::string(repoPath.generic_string().front() == '/' ? "" : "/") +
+              repoPath.generic_string();
+    git.CurrentSubmoduleInitType = runcpp2::Data::SubmoduleInitType::NONE;
+    
+    const ghc::filesystem::path firstCopyPath = testDir / "FirstScript" / "Repository";
+    const ghc::filesystem::path secondCopyPath = testDir / "SecondScript" / "Repository";
+    DS_ASSERT_TRUE(ghc::filesystem::create_directories(firstCopyPath.parent_path(), e));
+    DS_ASSERT_TRUE(ghc::filesystem::create_directories(secondCopyPath.parent_path(), e));
+    
+    //CloneFromGitMirror Should Clone Through The Mirror
+    {
+        DS_ASSERT_TRUE(CloneFromGitMirror(git, firstCopyPath, testDir, mirrorsDir, "", {}));
+        DS_ASSERT_TRUE(ghc::filesystem::exists(firstCopyPath / "Test.hpp", e));
+        DS_ASSERT_EQ(GetMirrorsCount(mirrorsDir), 1);
+        DS_ASSERT_TRUE(IsGitCopyValid(firstCopyPath, true));
+        
+        //The copy points to the repository instead of the mirror
+        std::string output;
+        int returnCode = 0;
+        DS_ASSERT_TRUE(runcpp2::RunCommand( "git remote get-url origin",
+                                            true,
+                                            firstCopyPath.string(),
+                                            output,
+                                            returnCode));
+        DS_ASSERT_TRUE(output.find(git.URL) != std::string::npos);
+    }
+    
+    //CloneFromGitMirror Should Share The Mirror Between Copies
+    {
+        DS_ASSERT_TRUE(CloneFromGitMirror(git, secondCopyPath, testDir, mirrorsDir, "", {}));
+        DS_ASSERT_TRUE(ghc::filesystem::exists(secondCopyPath / "Test.hpp", e));
+        DS_ASSERT_EQ(GetMirrorsCount(mirrorsDir), 1);
+        DS_ASSERT_TRUE(ghc::filesystem::exists( secondCopyPath / ".git" / "objects" / "info" /
+                                                "alternates",
+                                                e));
+    }
+    
+    //IsGitCopyValid Should Fail When The Mirror Is Removed
+    {
+        ghc::filesystem::remove_all(mirrorsDir, e);
+        DS_ASSERT_FALSE(ghc::filesystem::exists(mirrorsDir, e));
+        DS_ASSERT_FALSE(IsGitCopyValid(firstCopyPath, false));
+        DS_ASSERT_FALSE(IsGitCopyValid(firstCopyPath, true));
+    }
+    
+    //CloneFromGitMirror Should Clone Again After The Mirror Is Removed
+    {
+        DS_ASSERT_TRUE(ghc::filesystem::create_directories(mirrorsDir, e));
+        ghc::filesystem::remove_all(firstCopyPath, e);
+        DS_ASSERT_TRUE(CloneFromGitMirror(git, firstCopyPath, testDir, mirrorsDir, "", {}));
+        DS_ASSERT_TRUE(IsGitCopyValid(firstCopyPath, true));
+    }
+    
+    return {};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TestMain().DS_TRY_ACT(ssLOG_LINE(DS_TMP_ERROR.ToString()); return 1);
+        return 0;
+    }
+    catch(std::exception& ex)
+    {
+        ssLOG_LINE(ex.what());
+        return 1;
+    }
+    return 1;
+}
@@ -0,0 +1,89 @@
+#include "runcpp2/HashUtil.hpp"
+#include "runcpp2/runcpp2.hpp"
+#include "ssLogger/ssLog.hpp"
+
+#include <fstream>
+#include <string>
+
+std::string GetSha256(const std::string& data)
+{
+    runcpp2::Sha256 hash;
+    hash.Update(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+    return hash.FinishHex();
+}
+
+DS::Result<void> TestMain()
+{
+    //Sha256 Should Match FIPS 180-4 Examples
+    {
+        DS_ASSERT_EQ(   GetSha256(""),
+                        "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+        DS_ASSERT_EQ(   GetSha256("abc"),
+                        "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+        DS_ASSERT_EQ(   GetSha256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                        "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    }
+    
+    //Sha256 Should Pad Messages Around The Block Boundary
+    {
+        //55 bytes is the longest message where the padding fits in the same block
+        DS_ASSERT_EQ(   GetSha256(std::string(55, 'a')),
+                        "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+        DS_ASSERT_EQ(   GetSha256(std::string(56, 'a')),
+                        "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+        DS_ASSERT_EQ(   GetSha256(std::string(64, 'a')),
+                        "ffe054fe7ae0cb6dc65c3af9b61d5209f439851db43d0ba5997337df154668eb");
+    }
+    
+    //Sha256 Should Give The Same Digest When Updated In Parts
+    {
+        const std::string data(1000000, 'a');
+        runcpp2::Sha256 hash;
+        for(std::size_t i = 0; i < data.size(); i += 1000)
+            hash.Update(reinterpret_cast<const unsigned char*>(data.data() + i), 1000);
+        
+        DS_ASSERT_EQ(   hash.FinishHex(),
+                        "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    }
+    
+    //GetFileSha256 Should Hash The File Contents
+    {
+        const ghc::filesystem::path filePath = "./HashUtilTestFile.txt";
+        {
+            std::ofstream file(filePath.string(), std::ios::binary);
+            DS_ASSERT_TRUE(file.is_open());
+            file << "abc";
+        }
+        
+        std::string digest;
+        bool result = runcpp2::GetFileSha256(filePath, digest);
+        std::error_code e;
+        ghc::filesystem::remove(filePath, e);
+        
+        DS_ASSERT_TRUE(result);
+        DS_ASSERT_EQ(digest, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    }
+    
+    //GetFileSha256 Should Fail For Missing File
+    {
+        std::string digest;
+        DS_ASSERT_FALSE(runcpp2::GetFileSha256("./HashUtilTestMissingFile.txt", digest));
+    }
+    
+    return {};
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TestMain().DS_TRY_ACT(ssLOG_LINE(DS_TMP_ERROR.ToString()); return 1);
+        return 0;
+    }
+    catch(std::exception& ex)
+    {
+        ssLOG_LINE(ex.what());
+        return 1;
+    }
+    return 1;
+}
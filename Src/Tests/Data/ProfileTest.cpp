@@ -121,6 +121,8 @@ DS::Result<void> TestMain()
                     DefaultPlatform: ""
                 CheckExistence:
                     DefaultPlatform: "g++ -v"
+                RPathFlag:
+                    Unix: "-Wl,-rpath,\"{Stage.RPath}\""
                 LinkTypes:
                     Executable:
                         Unix:
@@ -249,6 +251,7 @@ DS::Result<void> TestMain()
         
         //Verify Linker
         DS_ASSERT_EQ(profile.Linker.CheckExistence.at("DefaultPlatform"), "g++ -v");
+        DS_ASSERT_EQ(profile.Linker.RPathFlag.at("Unix"), "-Wl,-rpath,\"{Stage.RPath}\"");
         const auto& executableLink = profile.Linker.OutputTypes.Executable.at("Unix");
         DS_ASSERT_EQ(executableLink.Flags, "-Wl,-rpath,\\$ORIGIN");
         DS_ASSERT_EQ(executableLink.Executable, "g++");
@@ -53,10 +53,17 @@ DS::Result<void> TestMain()
                     GCC:
                     -   src/extra.cpp
                     -   src/optimized.cpp
+            UnityBuild: true
+            UnityExcludedSourceFiles:
+                Linux:
+                    GCC:
+                    -   src/optimized.cpp
             IncludePaths:
                 Windows:
                     MSVC:
                     -   include
+            PruneDependencyIncludePaths: true
+            SharedDependenciesRPath: true
             Defines:
                 Windows:
                     MSVC:
@@ -199,11 +206,20 @@ DS::Result<void> TestMain()
         DS_ASSERT_EQ(gccCompileFiles.size(), 2);
         DS_ASSERT_EQ(gccCompileFiles.at(1), "src/optimized.cpp");
         
+        //Verify UnityBuild
+        DS_ASSERT_TRUE(scriptInfo.UnityBuild);
+        const std::vector<ghc::filesystem::path>& gccUnityExcludedFiles = 
+            scriptInfo.UnityExcludedSourceFiles.at("Linux").Paths.at("GCC");
+        DS_ASSERT_EQ(gccUnityExcludedFiles.size(), 1);
+        DS_ASSERT_EQ(gccUnityExcludedFiles.at(0), "src/optimized.cpp");
+        
         //Verify IncludePaths
         const std::vector<ghc::filesystem::path>& msvcIncludeFiles = 
             scriptInfo.IncludePaths.at("Windows").Paths.at("MSVC");
         DS_ASSERT_EQ(msvcIncludeFiles.size(), 1);
         DS_ASSERT_EQ(msvcIncludeFiles.at(0), "include");
+        DS_ASSERT_TRUE(scriptInfo.PruneDependencyIncludePaths);
+        DS_ASSERT_TRUE(scriptInfo.SharedDependenciesRPath);
 
         //Verify Defines
         const std::vector<runcpp2::Data::Define>& msvcDefines = 
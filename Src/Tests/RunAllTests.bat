@@ -38,8 +38,12 @@ GOTO :FINAL
 
 :FINAL
 CALL :RUN_TEST "%~dp0\%MODE%BuildTypeTest.exe"
+CALL :RUN_TEST "%~dp0\%MODE%DependenciesLockTest.exe"
 CALL :RUN_TEST "%~dp0\%MODE%DependencyInfoTest.exe"
 CALL :RUN_TEST "%~dp0\%MODE%DependencySourceTest.exe"
+CALL :RUN_TEST "%~dp0\%MODE%DependencyReadyRecordTest.exe"
+CALL :RUN_TEST "%~dp0\%MODE%GitMirrorTest.exe"
+CALL :RUN_TEST "%~dp0\%MODE%HashUtilTest.exe"
 CALL :RUN_TEST "%~dp0\%MODE%ProfileTest.exe"
 CALL :RUN_TEST "%~dp0\%MODE%ScriptInfoTest.exe"
 CALL :RUN_TEST "%~dp0\%MODE%BuildsManagerTest.exe"
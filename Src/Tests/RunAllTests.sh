@@ -14,8 +14,12 @@ function runTest()
 }
 
 runTest ./BuildTypeTest
+runTest ./DependenciesLockTest
 runTest ./DependencyInfoTest
 runTest ./DependencySourceTest
+runTest ./DependencyReadyRecordTest
+runTest ./GitMirrorTest
+runTest ./HashUtilTest
 runTest ./ProfileTest
 runTest ./ScriptInfoTest
 runTest ./BuildsManagerTest
@@ -16,8 +16,10 @@
 #include "runcpp2/Data/ProfilesFlagsOverride.hpp"
 #include "runcpp2/Data/StageInfo.hpp"
 
+#include "runcpp2/IncludeManager.hpp"
 #include "runcpp2/PlatformUtil.hpp"
 #include "runcpp2/StringUtil.hpp"
+#include "runcpp2/JobPool.hpp"
 
 #if !defined(NOMINMAX)
     #define NOMINMAX 1
@@ -27,12 +29,21 @@
 #include "ssLogger/ssLog.hpp"
 #include "ghc/filesystem.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <future>
+#include <functional>
 #include <chrono>
 #include <string>
 #include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include <system_error>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <stdlib.h>
 
@@ -128,15 +139,287 @@ namespace
         #undef INTERN_POPULATE_SUB_MAP
     }
     
+    void PopulateIncludePathsMap(   const std::vector<ghc::filesystem::path>& sourceIncludePaths,
+                                    const std::vector<ghc::filesystem::path>& depIncludePaths,
+                                    runcpp2::SubstitutionMap& outSubstitutionMap)
+    {
+        outSubstitutionMap["{Stage.IncludeDirectory.Path}"] = {};
+        outSubstitutionMap["{Stage.IncludeDirectory.Source.Path}"] = {};
+        for(const ghc::filesystem::path& includePath : sourceIncludePaths)
+        {
+            std::string processedInclude = runcpp2::ProcessPath(includePath.string());
+            outSubstitutionMap["{Stage.IncludeDirectory.Path}"].push_back(processedInclude);
+            outSubstitutionMap["{Stage.IncludeDirectory.Source.Path}"].push_back(processedInclude);
+        }
+        
+        outSubstitutionMap["{Stage.IncludeDirectory.Dep.Path}"] = {};
+        for(const ghc::filesystem::path& includePath : depIncludePaths)
+        {
+            std::string processedInclude = runcpp2::ProcessPath(includePath.string());
+            outSubstitutionMap["{Stage.IncludeDirectory.Path}"].push_back(processedInclude);
+            outSubstitutionMap["{Stage.IncludeDirectory.Dep.Path}"].push_back(processedInclude);
+        }
+    }
+    
+    struct CompileRecord
+    {
+        int64_t PeakMemoryKB = 0;
+        int64_t DurationMs = -1;
+    };
+    
+    //NOTE: Each line is "<relative source path>\t<peak memory in KB>\t<compile duration in ms>"
+    void ReadCompileRecords(const ghc::filesystem::path& buildDir,
+                            std::unordered_map<std::string, CompileRecord>& outRecords)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        std::error_code e;
+        const ghc::filesystem::path recordsPath = buildDir / "CompileRecords";
+        if(!ghc::filesystem::exists(recordsPath, e))
+            return;
+        
+        std::ifstream recordsFile(recordsPath);
+        if(!recordsFile.is_open())
+        {
+            ssLOG_WARNING("Failed to open compile records: " << recordsPath.string());
+            return;
+        }
+        
+        std::string line;
+        while(std::getline(recordsFile, line))
+        {
+            std::size_t durationIndex = line.rfind('\t');
+            if(durationIndex == std::string::npos || durationIndex == 0)
+                continue;
+            
+            std::size_t memoryIndex = line.rfind('\t', durationIndex - 1);
+            if(memoryIndex == std::string::npos || memoryIndex == 0)
+                continue;
+            
+            CompileRecord record;
+            std::stringstream valueStream(line.substr(memoryIndex + 1));
+            if(!(valueStream >> record.PeakMemoryKB >> record.DurationMs))
+                continue;
+            
+            outRecords[line.substr(0, memoryIndex)] = record;
+        }
+    }
+    
+    void WriteCompileRecords(   const ghc::filesystem::path& buildDir,
+                                const std::unordered_map<std::string, CompileRecord>& records)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        const ghc::filesystem::path recordsPath = buildDir / "CompileRecords";
+        std::ofstream recordsFile(recordsPath);
+        if(!recordsFile.is_open())
+        {
+            ssLOG_WARNING("Failed to write compile records: " << recordsPath.string());
+            return;
+        }
+        
+        for(auto it = records.begin(); it != records.end(); ++it)
+        {
+            recordsFile <<  it->first << "\t" << 
+                            it->second.PeakMemoryKB << "\t" << 
+                            it->second.DurationMs << "\n";
+        }
+    }
+    
+    //NOTE: Shared by the compiles of a script, it must outlive all of them
+    struct CompileContext
+    {
+        runcpp2::JobPool* Pool = nullptr;
+        std::unordered_map<std::string, CompileRecord>* Records = nullptr;
+        std::mutex RecordsMutex;
+        std::atomic<bool> Cancelled;
+        bool FailFast = false;
+        int LogLevel = 0;
+        std::string BuildDir;
+    };
+    
+    //NOTE: The setup, compile and cleanup commands of a source file. Each command is started when 
+    //      the previous one finishes, so no thread is waiting for them while they are running.
+    struct CompileSteps
+    {
+        CompileContext* Context = nullptr;
+        std::vector<std::string> Commands;
+        int CompileCommandIndex = 0;
+        std::string RecordKey;
+        runcpp2::JobPool::Slot Slot;
+        std::chrono::steady_clock::time_point StartTime;
+        int64_t PeakMemoryKB = 0;
+        std::promise<bool> Result;
+    };
+    
+    bool GetCompileCommands(const runcpp2::Data::Profile& profile,
+                            const runcpp2::Data::OutputTypeInfo& outputTypeInfo,
+                            const runcpp2::Data::ScriptInfo& scriptInfo,
+                            const std::unordered_map<   std::string, 
+                                                        std::vector<std::string>>& substitutionMap,
+                            const std::vector<char>& escapeChars,
+                            CompileSteps& outSteps)
+    {
+        //Getting PreRun command
+        std::string preRun =    runcpp2::HasValueFromPlatformMap(profile.Compiler.PreRun) ?
+                                *runcpp2::GetValueFromPlatformMap(profile.Compiler.PreRun) : "";
+        
+        //Run setup first if any
+        for(int j = 0; j < outputTypeInfo.Setup.size(); ++j)
+        {
+            std::string setupStep = outputTypeInfo.Setup.at(j);
+            runcpp2::PerformSubstitutions(substitutionMap, escapeChars, setupStep)
+                .DS_TRY_ACT(ssLOG_ERROR(DS_TMP_ERROR.ToString()); return false);
+            
+            outSteps.Commands.push_back(preRun.empty() ? setupStep : preRun + " && " + setupStep);
+        }
+        
+        //Construct the compile command
+        std::string runPartSubstitutedCommand;
+        if(!profile.Compiler.ConstructCommand(  substitutionMap, 
+                                                scriptInfo.CurrentBuildType,
+                                                escapeChars,
+                                                runPartSubstitutedCommand))
+        {
+            ssLOG_ERROR("Failed to construct compile command");
+            return false;
+        }
+        
+        outSteps.CompileCommandIndex = outSteps.Commands.size();
+        outSteps.Commands.push_back(preRun.empty() ? 
+                                    runPartSubstitutedCommand : 
+                                    preRun + " && " + runPartSubstitutedCommand);
+        
+        //Run cleanup if any
+        for(int j = 0; j < outputTypeInfo.Cleanup.size(); ++j)
+        {
+            std::string cleanupStep = outputTypeInfo.Cleanup.at(j);
+            runcpp2::PerformSubstitutions(substitutionMap, escapeChars, cleanupStep)
+                .DS_TRY_ACT(ssLOG_ERROR(DS_TMP_ERROR.ToString()); return false);
+            
+            outSteps.Commands.push_back(preRun.empty() ? 
+                                        cleanupStep : 
+                                        preRun + " && " + cleanupStep);
+        }
+        
+        return true;
+    }
+    
+    //NOTE: The steps must not be used after this since the compile context can be gone once the 
+    //      result is set
+    void FinishCompileSteps(const std::shared_ptr<CompileSteps>& steps, bool success)
+    {
+        steps->Context->Pool->ReleaseSlot(steps->Slot);
+        steps->Result.set_value(success);
+    }
+    
+    void RunCompileStep(std::shared_ptr<CompileSteps> steps, int stepIndex)
+    {
+        CompileContext& context = *steps->Context;
+        const bool isCompileCommand = stepIndex == steps->CompileCommandIndex;
+        if(isCompileCommand)
+        {
+            ssLOG_INFO( "running compile command: " << steps->Commands.at(stepIndex) <<
+                        " in " << context.BuildDir);
+        }
+        
+        runcpp2::RunCommandAsync
+        (
+            steps->Commands.at(stepIndex),
+            true,
+            context.BuildDir,
+            [steps, stepIndex, isCompileCommand](runcpp2::SubprocessResult result)
+            {
+                CompileContext& context = *steps->Context;
+                ssLOG_SET_CURRENT_THREAD_TARGET_LEVEL(context.LogLevel);
+                const std::string& command = steps->Commands.at(stepIndex);
+                
+                if(!result.Started || result.ReturnCode != 0)
+                {
+                    if(!isCompileCommand)
+                    {
+                        const std::string stepName =    stepIndex < steps->CompileCommandIndex ? 
+                                                        "Setup" : 
+                                                        "Cleanup";
+                        ssLOG_ERROR(stepName << " command \"" << command << "\" failed");
+                        ssLOG_ERROR("Failed with result " << result.ReturnCode);
+                        ssLOG_ERROR("Failed with output: \n" << result.Output);
+                    }
+                    //Only report the first failure, the others are likely terminated
+                    else if(context.FailFast && context.Cancelled.exchange(true))
+                        ssLOG_DEBUG("Compiling " << steps->RecordKey << " cancelled");
+                    else
+                    {
+                        ssLOG_ERROR("Compile command failed with result " << result.ReturnCode);
+                        ssLOG_ERROR("Was trying to run: " << command);
+                        ssLOG_ERROR("Compile output: \n" << result.Output);
+                        
+                        //Terminate the other compiles if this is the first failure
+                        if(context.FailFast)
+                            runcpp2::NotifyCommandsCancelled();
+                    }
+                    
+                    FinishCompileSteps(steps, false);
+                    return;
+                }
+                
+                if(isCompileCommand)
+                {
+                    //TODO: Make this configurable
+                    //Attempt to capture warnings
+                    if(result.Output.find(" warning") != std::string::npos)
+                        ssLOG_WARNING("Warning detected:\n" << result.Output);
+                    else
+                        ssLOG_INFO("Compile output:\n" << result.Output);
+                    
+                    steps->PeakMemoryKB = result.PeakMemoryKB;
+                }
+                
+                if(stepIndex + 1 < steps->Commands.size())
+                {
+                    RunCompileStep(steps, stepIndex + 1);
+                    return;
+                }
+                
+                const int64_t durationMs = 
+                    std::chrono::duration_cast<std::chrono::milliseconds>
+                    (
+                        std::chrono::steady_clock::now() - steps->StartTime
+                    ).count();
+                ssLOG_INFO("Compiled " << steps->RecordKey << " in " << durationMs << "ms");
+                
+                //NOTE: The peak memory is only recorded when it is measured for the compile 
+                //      process itself, keeping the previous record otherwise
+                {
+                    std::unique_lock<std::mutex> lock(context.RecordsMutex);
+                    CompileRecord& record = (*context.Records)[steps->RecordKey];
+                    record.DurationMs = durationMs;
+                    if(steps->PeakMemoryKB > 0)
+                        record.PeakMemoryKB = steps->PeakMemoryKB;
+                }
+                
+                FinishCompileSteps(steps, true);
+            },
+            isCompileCommand && context.FailFast ? &context.Cancelled : nullptr
+        );
+    }
+    
+    //NOTE: Only the sources in sourcesReadyToCompile are compiled before the dependencies are 
+    //      built. The rest are compiled after waitForDependencies since they might include headers 
+    //      from the dependencies that are not built yet.
     bool CompileScript( const ghc::filesystem::path& buildDir,
                         const ghc::filesystem::path& scriptDirectory,
                         const std::vector<ghc::filesystem::path>& sourceFiles,
                         const std::vector<ghc::filesystem::path>& sourceIncludePaths,
                         const std::vector<ghc::filesystem::path>& depIncludePaths,
+                        const runcpp2::SourceIncludeMap& sourcesDepIncludePaths,
+                        const std::unordered_set<std::string>& sourcesReadyToCompile,
+                        const std::function<DS::Result<void>()>& waitForDependencies,
                         const runcpp2::Data::ScriptInfo& scriptInfo,
                         const runcpp2::Data::Profile& profile,
                         std::vector<ghc::filesystem::path>& outObjectsFilesPaths,
-                        const int maxThreads)
+                        runcpp2::JobPool& jobPool,
+                        const bool failFast)
     {
         ssLOG_FUNC_INFO();
         
@@ -189,23 +472,6 @@ namespace
             substitutionMapTemplate["{Stage.CompileFlags}"] = {compileFlags};
         }
         
-        //Add source and dependency include paths
-        substitutionMapTemplate["{Stage.IncludeDirectory.Path}"] = {};
-        for(const ghc::filesystem::path& includePath : sourceIncludePaths)
-        {
-            std::string processedInclude = runcpp2::ProcessPath(includePath.string());
-            substitutionMapTemplate["{Stage.IncludeDirectory.Path}"].push_back(processedInclude);
-            substitutionMapTemplate["{Stage.IncludeDirectory.Source.Path}"].push_back(processedInclude);
-        }
-        
-        substitutionMapTemplate["{Stage.IncludeDirectory.Dep.Path}"] = {};
-        for(const ghc::filesystem::path& includePath : depIncludePaths)
-        {
-            std::string processedInclude = runcpp2::ProcessPath(includePath.string());
-            substitutionMapTemplate["{Stage.IncludeDirectory.Path}"].push_back(processedInclude);
-            substitutionMapTemplate["{Stage.IncludeDirectory.Dep.Path}"].push_back(processedInclude);
-        }
-        
         //Add defines
         substitutionMapTemplate["{Stage.DefineName}"] = {};
         substitutionMapTemplate["{Stage.DefineValue}"] = {};
@@ -240,32 +506,110 @@ namespace
         std::unordered_map<std::string, std::vector<std::string>> substitutionMap;
         substitutionMap = substitutionMapTemplate;
         std::vector<std::future<bool>> actions;
-        std::vector<bool> finished;
+        
+        //Memory used by each source file in previous runs, for keeping under the memory limit.
+        //Source files that are never compiled before use the largest one as estimate.
+        std::unordered_map<std::string, CompileRecord> compileRecords;
+        int64_t defaultMemoryEstimateKB = 0;
+        ReadCompileRecords(buildDir, compileRecords);
+        for(auto it = compileRecords.begin(); it != compileRecords.end(); ++it)
+        {
+            if(it->second.PeakMemoryKB > defaultMemoryEstimateKB)
+                defaultMemoryEstimateKB = it->second.PeakMemoryKB;
+        }
+        
+        //Start the source files that took the longest to compile last time first, so that they 
+        //don't hold up the build at the end. Source files without a record are started first.
+        std::vector<int> compileOrder;
+        std::vector<int64_t> lastDurations;
+        for(int i = 0; i < sourceFiles.size(); ++i)
+        {
+            std::error_code e;
+            ghc::filesystem::path relativeSourcePath = 
+                runcpp2::GetSourceRelativePath(sourceFiles.at(i), scriptDirectory, buildDir, e);
+            
+            const std::string recordKey = relativeSourcePath.generic_string();
+            compileOrder.push_back(i);
+            if( !e && 
+                compileRecords.count(recordKey) > 0 && 
+                compileRecords.at(recordKey).DurationMs >= 0)
+            {
+                lastDurations.push_back(compileRecords.at(recordKey).DurationMs);
+            }
+            else
+                lastDurations.push_back(INT64_MAX);
+        }
+        
+        std::stable_sort(   compileOrder.begin(), 
+                            compileOrder.end(), 
+                            [&lastDurations](int a, int b) 
+                            { 
+                                return lastDurations.at(a) > lastDurations.at(b); 
+                            });
+        
+        //Start the sources that don't need to wait for the dependencies first
+        std::stable_partition(  compileOrder.begin(), 
+                                compileOrder.end(), 
+                                [&sourceFiles, &sourcesReadyToCompile](int index)
+                                {
+                                    return sourcesReadyToCompile.count
+                                    (
+                                        sourceFiles.at(index).string()
+                                    ) > 0;
+                                });
+        
+        //NOTE: Object files are stored per source file so that they are outputted in the same
+        //      order as the source files regardless of the compile order
+        std::vector<std::vector<ghc::filesystem::path>> sourcesObjectsPaths(sourceFiles.size());
+        const std::chrono::steady_clock::time_point compileStartTime = 
+            std::chrono::steady_clock::now();
 
-        //Cache logs for worker threads
-        ssLOG_ENABLE_CACHE_OUTPUT_FOR_NEW_THREADS();
-        int logLevel = ssLOG_GET_CURRENT_THREAD_TARGET_LEVEL();
         #ifdef _WIN32
             const std::vector<char> escapeChars = {'\\', '^'};
         #else
             const std::vector<char> escapeChars = {'\\'};
         #endif
         
-        //Compile async, allow compilation for all source files whether if it succeeded or not
+        //Compile async, allow compilation for all source files whether if it succeeded or not.
+        //In fail fast mode, the first failure cancels the rest of the compilations instead.
         bool failedAny = false;
-        for(int i = 0; i < sourceFiles.size(); ++i)
+        bool dependenciesWaited = false;
+        CompileContext compileContext;
+        compileContext.Pool = &jobPool;
+        compileContext.Records = &compileRecords;
+        compileContext.Cancelled = false;
+        compileContext.FailFast = failFast;
+        compileContext.LogLevel = ssLOG_GET_CURRENT_THREAD_TARGET_LEVEL();
+        compileContext.BuildDir = buildDir.string();
+        for(int orderIndex = 0; orderIndex < compileOrder.size(); ++orderIndex)
         {
+            const int i = compileOrder.at(orderIndex);
             std::error_code e;
             ghc::filesystem::path currentSource = sourceFiles.at(i);
+            
+            //The sources that are started already keep compiling while waiting
+            if(!dependenciesWaited && sourcesReadyToCompile.count(currentSource.string()) == 0)
+            {
+                dependenciesWaited = true;
+                DS::Result<void> waitResult = waitForDependencies();
+                if(!waitResult.HasValue())
+                {
+                    ssLOG_ERROR(waitResult.Error().ToString());
+                    ssLOG_ERROR("Failed to wait for dependencies before compiling");
+                    failedAny = true;
+                    compileContext.Cancelled = true;
+                    runcpp2::NotifyCommandsCancelled();
+                    break;
+                }
+            }
             ghc::filesystem::path relativeSourcePath = 
-                ghc::filesystem::relative(currentSource, scriptDirectory, e);
+                runcpp2::GetSourceRelativePath(currentSource, scriptDirectory, buildDir, e);
             
             if(e)
             {
                 ssLOG_ERROR("Failed to get relative path for " << currentSource);
                 ssLOG_ERROR("Failed with error: " << e.message());
                 actions.emplace_back(std::async(std::launch::deferred, []{return false;}));
-                finished.emplace_back(false);
                 continue;
             }
             
@@ -281,6 +625,14 @@ namespace
                 substitutionMap["{Stage.Input.Path}"] = {currentSource.string()};
             }
             
+            //Add source and dependency include paths. Only the dependency include paths used by 
+            //the source are added if they are pruned
+            PopulateIncludePathsMap(sourceIncludePaths,
+                                    sourcesDepIncludePaths.count(currentSource.string()) > 0 ?
+                                        sourcesDepIncludePaths.at(currentSource.string()) :
+                                        depIncludePaths,
+                                    substitutionMap);
+            
             //Output File
             {
                 substitutionMap["{Stage.Output.Directory}"] = 
@@ -291,7 +643,6 @@ namespace
                     ssLOG_ERROR("profile " << profile.Name << " missing extension for " <<
                                 "object link file");
                     actions.emplace_back(std::async(std::launch::deferred, []{return false;}));
-                    finished.emplace_back(false);
                     continue;
                 }
                 
@@ -308,7 +659,6 @@ namespace
                     {
                         ssLOG_ERROR(res.Error().ToString());
                         actions.emplace_back(std::async(std::launch::deferred, []{return false;}));
-                        finished.emplace_back(false);
                         continue;
                     }
                     
@@ -319,7 +669,6 @@ namespace
                         ssLOG_ERROR("Failed to create directory structure for " << currentPath);
                         ssLOG_ERROR("Failed with error: " << e.message());
                         actions.emplace_back(std::async(std::launch::deferred, []{return false;}));
-                        finished.emplace_back(false);
                         continue;
                     }
                     
@@ -329,204 +678,88 @@ namespace
                         continue;
                     }
                     
-                    outObjectsFilesPaths.push_back(currentPath);
+                    sourcesObjectsPaths.at(i).push_back(currentPath);
                     //TODO: Check if the current path exists after performing the compilation
                 }
             }
             
-            actions.emplace_back
-            (
-                std::async
-                (
-                    std::launch::async,
-                    //Compile the source
-                    [
-                        i,
-                        &profile,
-                        &currentOutputTypeInfo,
-                        substitutionMap,    //NOTE: substitutionMap is used by the next source file, 
-                                            //      therefore need to copy it.
-                        &buildDir,
-                        &scriptInfo,
-                        logLevel,
-                        &escapeChars
-                    ]()
-                    {
-                        ssLOG_SET_CURRENT_THREAD_TARGET_LEVEL(logLevel);
-                        
-                        //Getting PreRun command
-                        std::string preRun =    
-                            runcpp2::HasValueFromPlatformMap(profile.Compiler.PreRun) ?
-                            *runcpp2::GetValueFromPlatformMap(profile.Compiler.PreRun) : "";
-                        
-                        //Run setup first if any
-                        for(int j = 0; j < currentOutputTypeInfo->Setup.size(); ++j)
-                        {
-                            std::string setupStep = currentOutputTypeInfo->Setup.at(j);
-                            
-                            DS::Result<void> res = runcpp2::PerformSubstitutions(   substitutionMap, 
-                                                                                    escapeChars, 
-                                                                                    setupStep);
-                            if(!res.HasValue())
-                            {
-                                ssLOG_ERROR(res.Error().ToString());
-                                return false;
-                            }
-                            
-                            if(!preRun.empty())
-                                setupStep = preRun + " && " + setupStep;
-                            
-                            std::string setupOutput;
-                            int setupResult;
-                            if( !runcpp2::RunCommand(   setupStep, 
-                                                        true,
-                                                        buildDir.string(),
-                                                        setupOutput, 
-                                                        setupResult) || 
-                                setupResult != 0)
-                            {
-                                ssLOG_ERROR("Setup command \"" << setupStep << "\" failed");
-                                ssLOG_ERROR("Failed with result " << setupResult);
-                                ssLOG_ERROR("Failed with output: \n" << setupOutput);
-                                return false;
-                            }
-                        }
-                        
-                        std::string compileCommand;
-                        
-                        //Construct the compile command
-                        {
-                            std::string runPartSubstitutedCommand;
-                            if(!profile.Compiler.ConstructCommand(  substitutionMap, 
-                                                                    scriptInfo.CurrentBuildType,
-                                                                    escapeChars,
-                                                                    runPartSubstitutedCommand))
-                            {
-                                ssLOG_ERROR("Failed to construct compile command");
-                                return false;
-                            }
-                            
-                            if(!preRun.empty())
-                                compileCommand = preRun + " && " + runPartSubstitutedCommand;
-                            else
-                                compileCommand = runPartSubstitutedCommand;
-                            
-                            ssLOG_INFO( "running compile command: " << compileCommand <<
-                                         " in " << buildDir.string());
-                            
-                            std::string commandOutput;
-                            int resultCode = 0;
-                            
-                            if( !runcpp2::RunCommand(   compileCommand, 
-                                                        true,
-                                                        buildDir.string(),
-                                                        commandOutput, 
-                                                        resultCode) || 
-                                resultCode != 0)
-                            {
-                                ssLOG_ERROR("Compile command failed with result " << resultCode);
-                                ssLOG_ERROR("Was trying to run: " << compileCommand);
-                                ssLOG_ERROR("Compile output: \n" << commandOutput);
-                                return false;
-                            }
-                            else
-                            {
-                                //TODO: Make this configurable
-                                //Attempt to capture warnings
-                                if(commandOutput.find(" warning") != std::string::npos)
-                                    ssLOG_WARNING("Warning detected:\n" << commandOutput);
-                                else
-                                    ssLOG_INFO("Compile output:\n" << commandOutput);
-                            }
-                        }
-                        
-                        //Run cleanup if any
-                        for(int j = 0; j < currentOutputTypeInfo->Cleanup.size(); ++j)
-                        {
-                            std::string cleanupStep = currentOutputTypeInfo->Cleanup.at(j);
-                            runcpp2::PerformSubstitutions(substitutionMap, escapeChars, cleanupStep)
-                                .DS_TRY_ACT(ssLOG_ERROR(DS_TMP_ERROR.ToString()); return false);
-                            
-                            if(!preRun.empty())
-                                cleanupStep = preRun + " && " + cleanupStep;
-                            
-                            std::string cleanupOutput;
-                            int cleanupResult;
-                            
-                            if( !runcpp2::RunCommand(   cleanupStep, 
-                                                        true,
-                                                        buildDir.string(),
-                                                        cleanupOutput, 
-                                                        cleanupResult) || 
-                                cleanupResult != 0)
-                            {
-                                ssLOG_ERROR("Cleanup command \"" << cleanupStep << "\" failed");
-                                ssLOG_ERROR("Failed with result " << cleanupResult);
-                                ssLOG_ERROR("Failed with output: \n" << cleanupOutput);
-                                return false;
-                            }
-                        }
-                        
-                        return true;
-                    }
-                ) //std::async
-            ); //actions.emplace_back
-            finished.emplace_back(false);
+            const std::string recordKey = relativeSourcePath.generic_string();
+            int64_t memoryEstimateKB = defaultMemoryEstimateKB;
+            {
+                std::unique_lock<std::mutex> lock(compileContext.RecordsMutex);
+                if(compileRecords.count(recordKey) > 0)
+                    memoryEstimateKB = compileRecords.at(recordKey).PeakMemoryKB;
+            }
             
-            //Evaluate the compile results for each batch for compilations
-            if(actions.size() >= maxThreads || i == sourceFiles.size() - 1)
+            std::shared_ptr<CompileSteps> steps = std::make_shared<CompileSteps>();
+            steps->Context = &compileContext;
+            steps->RecordKey = recordKey;
+            if(!GetCompileCommands( profile, 
+                                    *currentOutputTypeInfo, 
+                                    scriptInfo, 
+                                    substitutionMap, 
+                                    escapeChars, 
+                                    *steps))
             {
-                bool needsWaiting = false;
-                do
-                {
-                    needsWaiting = false;
-                    std::chrono::system_clock::time_point deadline = 
-                        std::chrono::system_clock::now() + std::chrono::seconds(60);
-                    for(int j = 0; j < actions.size(); ++j)
-                    {
-                        if(finished.at(j))
-                            continue;
-                        
-                        if(!actions.at(j).valid())
-                        {
-                            ssLOG_ERROR("Failed to construct actions for compiling");
-                            ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                            return false;
-                        }
-                        
-                        std::future_status actionStatus = actions.at(j).wait_until(deadline);
-                        bool result = false;
-                        
-                        if( actionStatus == std::future_status::deferred || 
-                            actionStatus == std::future_status::ready)
-                        {
-                            result = actions.at(j).get();
-                            finished.at(j) = true;
-                            
-                            if(!result)
-                            {
-                                ssLOG_ERROR("Compiling Failed");
-                                ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                                failedAny = true;
-                            }
-                        }
-                        else
-                        {
-                            ssLOG_WARNING("Manual interrupt might be needed");
-                            ssLOG_WARNING("Waited 30 seconds, compiling still going...");
-                            needsWaiting = true;
-                            result = true;
-                        }
-                    }
-                }
-                while(needsWaiting);
-                
-                actions.clear();
-                finished.clear();
-            } //if(actions.size() >= maxThreads || i == sourceFiles.size() - 1)
-        } //for(int i = 0; i < sourceFiles.size(); ++i)
-
+                actions.emplace_back(std::async(std::launch::deferred, []{return false;}));
+                continue;
+            }
+            
+            actions.emplace_back(steps->Result.get_future());
+            
+            //Wait for a slot to free up, the running compiles finish on the subprocess waiting 
+            //thread without holding any thread here
+            steps->Slot = jobPool.AcquireSlot(memoryEstimateKB);
+            if(compileContext.Cancelled)
+            {
+                ssLOG_DEBUG("Compiling " << recordKey << " cancelled");
+                FinishCompileSteps(steps, false);
+                continue;
+            }
+            
+            steps->StartTime = std::chrono::steady_clock::now();
+            RunCompileStep(steps, 0);
+        } //for(int orderIndex = 0; orderIndex < compileOrder.size(); ++orderIndex)
+        
+        for(int i = 0; i < sourcesObjectsPaths.size(); ++i)
+        {
+            outObjectsFilesPaths.insert(outObjectsFilesPaths.end(), 
+                                        sourcesObjectsPaths.at(i).begin(), 
+                                        sourcesObjectsPaths.at(i).end());
+        }
+        
+        //Wait for all the compilations
+        //NOTE: We can't return early here since the compiles are referencing the local variables.
+        for(int i = 0; i < actions.size(); ++i)
+        {
+            if(!actions.at(i).valid())
+            {
+                ssLOG_ERROR("Failed to construct actions for compiling");
+                failedAny = true;
+                continue;
+            }
+            
+            while(actions.at(i).wait_for(std::chrono::seconds(60)) == std::future_status::timeout)
+            {
+                ssLOG_WARNING("Manual interrupt might be needed");
+                ssLOG_WARNING("Waited 60 seconds, compiling still going...");
+            }
+            
+            if(!actions.at(i).get())
+            {
+                if(!failFast || !failedAny)
+                    ssLOG_ERROR("Compiling Failed");
+                failedAny = true;
+            }
+        }
+        
+        WriteCompileRecords(buildDir, compileRecords);
         ssLOG_OUTPUT_ALL_CACHE_GROUPED();
+        ssLOG_INFO( "Compiling " << sourceFiles.size() << " source files took " << 
+                    std::chrono::duration_cast<std::chrono::milliseconds>
+                    (
+                        std::chrono::steady_clock::now() - compileStartTime
+                    ).count() << "ms");
         return !failedAny;
     }
 
@@ -541,6 +774,7 @@ namespace
                     const std::string& outputName, 
                     const runcpp2::Data::ScriptInfo& scriptInfo,
                     const std::string& additionalLinkFlags,
+                    const std::vector<std::string>& rpathDirectories,
                     const runcpp2::Data::Profile& profile,
                     const std::vector<LinkPriorities> priorities)
                     //const std::vector<ghc::filesystem::path>& objectsFilesPaths)
@@ -593,6 +827,28 @@ namespace
                     linkFlags += std::string(" ") + additionalLinkFlags;
             }
             
+            //Put the rpath flags first so that the shared dependencies are loaded from where they 
+            //are before the ones next to the output
+            const std::string* rpathFlag = 
+                runcpp2::GetValueFromPlatformMap(profile.Linker.RPathFlag);
+            if(rpathFlag != nullptr && !rpathDirectories.empty())
+            {
+                std::string rpathFlags;
+                for(int i = 0; i < rpathDirectories.size(); ++i)
+                {
+                    runcpp2::SubstitutionMap rpathSubstitutionMap;
+                    rpathSubstitutionMap["{Stage.RPath}"] = {rpathDirectories.at(i)};
+                    
+                    std::string currentRPathFlag = *rpathFlag;
+                    runcpp2::PerformSubstitutions(rpathSubstitutionMap, {}, currentRPathFlag)
+                        .DS_TRY_ACT(ssLOG_ERROR(DS_TMP_ERROR.ToString()); return false);
+                    rpathFlags += currentRPathFlag + " ";
+                }
+                
+                linkFlags = rpathFlags + linkFlags;
+                runcpp2::TrimRight(linkFlags);
+            }
+            
             substitutionMap["{Stage.LinkFlags}"] = {linkFlags};
         }
         
@@ -950,9 +1206,13 @@ namespace runcpp2
                         const std::vector<bool>& sourceHasCache,
                         const std::vector<ghc::filesystem::path>& sourceIncludePaths,
                         const std::vector<ghc::filesystem::path>& depIncludePaths,
+                        const SourceIncludeMap& sourcesDepIncludePaths,
+                        const std::unordered_set<std::string>& sourcesReadyToCompile,
+                        const std::function<DS::Result<void>()>& waitForDependencies,
                         const Data::ScriptInfo& scriptInfo,
                         const Data::Profile& profile,
-                        const int maxThreads)
+                        JobPool& jobPool,
+                        const bool failFast)
     {
         if(!RunGlobalSteps(buildDir, profile.Setup))
             return DS_ERROR_MSG("Failed to run profile global setup steps");
@@ -972,10 +1232,14 @@ namespace runcpp2
                             sourceFilesNeededToCompile, 
                             sourceIncludePaths,
                             depIncludePaths,
+                            sourcesDepIncludePaths,
+                            sourcesReadyToCompile,
+                            waitForDependencies,
                             scriptInfo, 
                             profile, 
                             objectsFilesPaths,
-                            maxThreads))
+                            jobPool,
+                            failFast))
         {
             if(!RunGlobalSteps(buildDir, profile.Cleanup))
                 return DS_ERROR_MSG("CompileScript failed. Failed to run profile global cleanup steps");
@@ -990,6 +1254,9 @@ namespace runcpp2
     }
     
     //TODO: Convert string paths to filesystem paths
+    //NOTE: waitForDependencies is called before compiling the sources not in sourcesReadyToCompile 
+    //      and before reading any of the binary files paths, allowing the dependencies to be built 
+    //      and the binary files to be populated while the other sources are being compiled.
     inline DS::Result<void> 
     CompileAndLinkScript(   const ghc::filesystem::path& buildDir,
                             const ghc::filesystem::path& scriptDirectory,
@@ -998,6 +1265,8 @@ namespace runcpp2
                             const std::vector<bool>& sourceHasCache,
                             const std::vector<ghc::filesystem::path>& sourceIncludePaths,
                             const std::vector<ghc::filesystem::path>& depIncludePaths,
+                            const SourceIncludeMap& sourcesDepIncludePaths,
+                            const std::unordered_set<std::string>& sourcesReadyToCompile,
                             const Data::ScriptInfo& scriptInfo,
                             const std::vector<Data::DependencyInfo*>& availableDependencies,
                             const Data::Profile& profile,
@@ -1005,11 +1274,11 @@ namespace runcpp2
                             const std::vector<int>& sourceBinaryFilesPriorities,
                             const std::vector<ghc::filesystem::path>& depBinaryFilesPaths,
                             const std::vector<int>& depBinaryFilesPriorities,
-                            const int maxThreads)
+                            const std::vector<std::string>& depRPathDirectories,
+                            const std::function<DS::Result<void>()>& waitForDependencies,
+                            JobPool& jobPool,
+                            const bool failFast)
     {
-        DS_ASSERT_EQ(sourceBinaryFilesPaths.size(), sourceBinaryFilesPriorities.size());
-        DS_ASSERT_EQ(depBinaryFilesPaths.size(), depBinaryFilesPriorities.size());
-        
         if(!RunGlobalSteps(buildDir, profile.Setup))
             return DS_ERROR_MSG("Failed to run profile global setup steps");
         
@@ -1028,10 +1297,14 @@ namespace runcpp2
                             sourceFilesNeededToCompile, 
                             sourceIncludePaths,
                             depIncludePaths,
+                            sourcesDepIncludePaths,
+                            sourcesReadyToCompile,
+                            waitForDependencies,
                             scriptInfo, 
                             profile, 
                             compiledObjectsFilesPaths,
-                            maxThreads))
+                            jobPool,
+                            failFast))
         {
             if(!RunGlobalSteps(buildDir, profile.Cleanup))
                 return DS_ERROR_MSG("CompileScript failed. Failed to run profile global cleanup steps");
@@ -1039,6 +1312,18 @@ namespace runcpp2
             return DS_ERROR_MSG("CompileScript failed");
         }
         
+        DS::Result<void> waitResult = waitForDependencies();
+        if(!waitResult.HasValue())
+        {
+            if(!RunGlobalSteps(buildDir, profile.Cleanup))
+                ssLOG_ERROR("Failed to run profile global cleanup steps");
+            
+            return waitResult;
+        }
+        
+        DS_ASSERT_EQ(sourceBinaryFilesPaths.size(), sourceBinaryFilesPriorities.size());
+        DS_ASSERT_EQ(depBinaryFilesPaths.size(), depBinaryFilesPriorities.size());
+        
         //Priorities for source files
         std::vector<LinkPriorities> priorities;
         for(int i = 0; i < compiledObjectsFilesPaths.size(); ++i)
@@ -1112,8 +1397,16 @@ namespace runcpp2
         
         runcpp2::TrimRight(dependenciesLinkFlags);
         
-        if(!LinkScript(buildDir, outputName, scriptInfo, dependenciesLinkFlags, profile, priorities))
+        if(!LinkScript( buildDir, 
+                        outputName, 
+                        scriptInfo, 
+                        dependenciesLinkFlags, 
+                        depRPathDirectories, 
+                        profile, 
+                        priorities))
+        {
             return DS_ERROR_MSG("LinkScript failed");
+        }
         
         if(!RunGlobalSteps(buildDir, profile.Cleanup))
             return DS_ERROR_MSG("Failed to run profile global cleanup steps");
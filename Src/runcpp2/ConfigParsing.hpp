@@ -324,6 +324,19 @@ namespace runcpp2
         return compilerConfigFilePaths[0];
     }
     
+    //NOTE: The directory for the files shared by all the scripts that can be recreated, such as 
+    //      the git mirrors and the dependencies build artifacts
+    inline DS::Result<ghc::filesystem::path> GetCacheDirectoryPath()
+    {
+        char cacheDirC_Str[MAX_PATH] = {0};
+        
+        //Cache directory is created by get_user_cache_folder if it doesn't exist
+        get_user_cache_folder(cacheDirC_Str, MAX_PATH, "runcpp2");
+        
+        DS_ASSERT_GT(strlen(cacheDirC_Str), 0);
+        return ghc::filesystem::path(std::string(cacheDirC_Str));
+    }
+    
     inline DS::Result<void> WriteDefaultConfigs(const ghc::filesystem::path& userConfigPath, 
                                                 const bool writeUserConfig,
                                                 const bool writeDefaultConfigs)
@@ -0,0 +1,85 @@
+#ifndef RUNCPP2_DATA_ARCHIVE_SOURCE_HPP
+#define RUNCPP2_DATA_ARCHIVE_SOURCE_HPP
+
+#include "runcpp2/Data/LocalSource.hpp"
+#include "runcpp2/LibYAML_Wrapper.hpp"
+#include "runcpp2/ParseUtil.hpp"
+
+#include "DSResult/DSResult.hpp"
+#include "ssLogger/ssLog.hpp"
+
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace runcpp2
+{
+namespace Data
+{
+    struct ArchiveSource
+    {
+        //Local path or file:// URL of the archive
+        std::string Path;
+        std::string SHA256;
+        LocalCopyMode CopyMode = LocalCopyMode::Auto;
+        
+        inline bool ParseYAML_Node(YAML::ConstNodePtr node)
+        {
+            std::vector<NodeRequirement> requirements =
+            {
+                NodeRequirement("Path", YAML::NodeType::Scalar, true, false),
+                NodeRequirement("SHA256", YAML::NodeType::Scalar, true, false)
+            };
+            
+            if(!CheckNodeRequirements(node, requirements))
+            {
+                ssLOG_ERROR("ArchiveSource: Failed to meet requirements");
+                return false;
+            }
+            
+            Path = node->GetMapValueScalar<std::string>("Path").DS_TRY_ACT(return false);
+            SHA256 = node->GetMapValueScalar<std::string>("SHA256").DS_TRY_ACT(return false);
+            
+            //Store the hash in lowercase so that it can be compared directly
+            for(int i = 0; i < SHA256.size(); ++i)
+                SHA256[i] = std::tolower(static_cast<unsigned char>(SHA256[i]));
+            
+            if( SHA256.size() != 64 || 
+                SHA256.find_first_not_of("0123456789abcdef") != std::string::npos)
+            {
+                ssLOG_ERROR("ArchiveSource: Invalid SHA256 hash " << SHA256);
+                return false;
+            }
+            
+            if(ExistAndHasChild(node, "CopyMode"))
+            {
+                bool success = false;
+                CopyMode = StringToCopyMode(node->GetMapValueScalar<std::string>("CopyMode")
+                                                .DefaultOr(),
+                                            success);
+                if(!success)
+                    return false;
+            }
+            
+            return true;
+        }
+        
+        inline std::string ToString(std::string indentation) const
+        {
+            std::string out;
+            out += indentation + "Archive:\n";
+            out += indentation + "    Path: " + GetEscapedYAMLString(Path) + "\n";
+            out += indentation + "    SHA256: " + GetEscapedYAMLString(SHA256) + "\n";
+            out += indentation + "    CopyMode: " + CopyModeToString(CopyMode) + "\n";
+            return out;
+        }
+        
+        inline bool Equals(const ArchiveSource& other) const
+        {
+            return Path == other.Path && SHA256 == other.SHA256 && CopyMode == other.CopyMode;
+        }
+    };
+}
+}
+
+#endif
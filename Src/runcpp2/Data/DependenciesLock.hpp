@@ -0,0 +1,141 @@
+#ifndef RUNCPP2_DATA_DEPENDENCIES_LOCK_HPP
+#define RUNCPP2_DATA_DEPENDENCIES_LOCK_HPP
+
+#include "runcpp2/LibYAML_Wrapper.hpp"
+#include "runcpp2/ParseUtil.hpp"
+
+#include "DSResult/DSResult.hpp"
+#include "ssLogger/ssLog.hpp"
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace runcpp2
+{
+namespace Data
+{
+    struct LockedRevision
+    {
+        //Where the revision is resolved from, such as the git url and branch. The revision is
+        //not used if the source of the dependency has changed.
+        std::string Source;
+        std::string Revision;
+        
+        inline bool ParseYAML_Node(YAML::ConstNodePtr node)
+        {
+            std::vector<NodeRequirement> requirements =
+            {
+                NodeRequirement("Source", YAML::NodeType::Scalar, true, false),
+                NodeRequirement("Revision", YAML::NodeType::Scalar, true, false)
+            };
+            
+            if(!CheckNodeRequirements(node, requirements))
+            {
+                ssLOG_ERROR("LockedRevision: Failed to meet requirements");
+                return false;
+            }
+            
+            Source = node->GetMapValueScalar<std::string>("Source").DS_TRY_ACT(return false);
+            Revision = node->GetMapValueScalar<std::string>("Revision").DS_TRY_ACT(return false);
+            return true;
+        }
+        
+        inline std::string ToString(std::string indentation) const
+        {
+            std::string out;
+            out += indentation + "Source: " + GetEscapedYAMLString(Source) + "\n";
+            out += indentation + "Revision: " + GetEscapedYAMLString(Revision) + "\n";
+            return out;
+        }
+        
+        inline bool Equals(const LockedRevision& other) const
+        {
+            return Source == other.Source && Revision == other.Revision;
+        }
+    };
+    
+    //NOTE: The resolved revisions of the git and archive dependencies of a script, keyed by the
+    //      dependency names. This is the commit for git dependencies and the archive hash for
+    //      archive dependencies.
+    struct DependenciesLock
+    {
+        //Ordered so that the lockfile stays the same when written again
+        std::map<std::string, LockedRevision> Revisions;
+        
+        inline bool ParseYAML_Node(YAML::ConstNodePtr node)
+        {
+            std::vector<NodeRequirement> requirements =
+            {
+                NodeRequirement("Revisions", YAML::NodeType::Map, false, true)
+            };
+            
+            if(!CheckNodeRequirements(node, requirements))
+            {
+                ssLOG_ERROR("DependenciesLock: Failed to meet requirements");
+                return false;
+            }
+            
+            if(!ExistAndHasChild(node, "Revisions"))
+                return true;
+            
+            YAML::ConstNodePtr revisionsNode = node->GetMapValueNode("Revisions");
+            for(int i = 0; i < revisionsNode->GetChildrenCount(); ++i)
+            {
+                std::string name = revisionsNode->GetMapKeyScalarAt<std::string>(i)
+                                                .DS_TRY_ACT(return false);
+                
+                YAML::ConstNodePtr revisionNode = revisionsNode->GetMapValueNodeAt(i);
+                if(!revisionNode->IsMap())
+                {
+                    ssLOG_ERROR("DependenciesLock: Revision of " << name << " is not a map");
+                    return false;
+                }
+                
+                LockedRevision lockedRevision;
+                if(!lockedRevision.ParseYAML_Node(revisionNode))
+                {
+                    ssLOG_ERROR("DependenciesLock: Failed to parse revision of " << name);
+                    return false;
+                }
+                
+                Revisions[name] = lockedRevision;
+            }
+            
+            return true;
+        }
+        
+        inline std::string ToString(std::string indentation) const
+        {
+            std::string out;
+            if(Revisions.empty())
+                return indentation + "Revisions: {}\n";
+            
+            out += indentation + "Revisions:\n";
+            for(auto it = Revisions.begin(); it != Revisions.end(); ++it)
+            {
+                out +=  indentation + "    " + GetEscapedYAMLString(it->first) + ":\n" +
+                        it->second.ToString(indentation + "        ");
+            }
+            return out;
+        }
+        
+        inline bool Equals(const DependenciesLock& other) const
+        {
+            if(Revisions.size() != other.Revisions.size())
+                return false;
+            
+            for(auto it = Revisions.begin(); it != Revisions.end(); ++it)
+            {
+                auto otherIt = other.Revisions.find(it->first);
+                if(otherIt == other.Revisions.end() || !it->second.Equals(otherIt->second))
+                    return false;
+            }
+            
+            return true;
+        }
+    };
+}
+}
+
+#endif
@@ -40,6 +40,7 @@ namespace Data
         std::unordered_map<PlatformName, ProfilesCommands> Cleanup;
         std::unordered_map<PlatformName, ProfilesCommands> Build;
         std::unordered_map<PlatformName, FilesToCopyInfo> FilesToCopy;
+        std::vector<std::string> DependsOn;
         
         //NOTE: This function is called from the caller until there's no import anymore
         inline DS::Result<void> 
@@ -91,6 +92,7 @@ namespace Data
                 
                 //Expecting either platform profile map or ProfileLinkProperty map
                 NodeRequirement("LinkProperties", YAML::NodeType::Map, false, false),
+                NodeRequirement("DependsOn", YAML::NodeType::Sequence, false, true),
                 
                 //Setup can be platform profile map or sequence of commands, handle later
                 //Cleanup can be platform profile map or sequence of commands, handle later
@@ -166,6 +168,17 @@ namespace Data
                                                                     "FilesToCopy", 
                                                                     FilesToCopy, 
                                                                     "FilesToCopy"));
+            
+            if(ExistAndHasChild(clonedNode, "DependsOn"))
+            {
+                YAML::ConstNodePtr dependsOnNode = clonedNode->GetMapValueNode("DependsOn");
+                for(int i = 0; i < dependsOnNode->GetChildrenCount(); ++i)
+                {
+                    std::string dependencyName = 
+                        dependsOnNode->GetSequenceChildScalar<std::string>(i).DS_TRY();
+                    DependsOn.push_back(dependencyName);
+                }
+            }
             return {};
         }
 
@@ -249,6 +262,13 @@ namespace Data
                 }
             }
             
+            if(!DependsOn.empty())
+            {
+                out += indentation + "DependsOn:\n";
+                for(auto it = DependsOn.begin(); it != DependsOn.end(); ++it)
+                    out += indentation + "-   " + GetEscapedYAMLString(*it) + "\n";
+            }
+            
             return out;
         }
 
@@ -264,7 +284,8 @@ namespace Data
                 Setup.size() != other.Setup.size() ||
                 Cleanup.size() != other.Cleanup.size() ||
                 Build.size() != other.Build.size() ||
-                FilesToCopy.size() != other.FilesToCopy.size())
+                FilesToCopy.size() != other.FilesToCopy.size() ||
+                DependsOn != other.DependsOn)
             {
                 return false;
             }
@@ -314,6 +335,85 @@ namespace Data
             return true;
         }
     };
+    
+    //NOTE: Groups the dependencies into waves based on DependsOn, where each dependency only 
+    //      depends on the ones in previous waves. Dependencies in the same wave can be processed
+    //      in parallel. Names in DependsOn that are not in the list are ignored since they can be
+    //      for other platforms or not imported yet.
+    inline DS::Result<void> 
+    GetDependenciesWaves(   const std::vector<const DependencyInfo*>& dependencies,
+                            std::vector<std::vector<int>>& outWaves)
+    {
+        outWaves.clear();
+        
+        std::unordered_map<std::string, int> nameIndices;
+        for(int i = 0; i < dependencies.size(); ++i)
+        {
+            if(nameIndices.count(dependencies.at(i)->Name) == 0)
+                nameIndices[dependencies.at(i)->Name] = i;
+        }
+        
+        //Count how many dependencies each dependency is waiting for
+        std::vector<int> waitingCounts(dependencies.size(), 0);
+        std::vector<std::vector<int>> dependents(dependencies.size());
+        for(int i = 0; i < dependencies.size(); ++i)
+        {
+            const std::vector<std::string>& dependsOn = dependencies.at(i)->DependsOn;
+            for(int j = 0; j < dependsOn.size(); ++j)
+            {
+                std::unordered_map<std::string, int>::const_iterator foundIt = 
+                    nameIndices.find(dependsOn.at(j));
+                
+                if(foundIt == nameIndices.end())
+                    continue;
+                
+                ++waitingCounts.at(i);
+                dependents.at(foundIt->second).push_back(i);
+            }
+        }
+        
+        std::vector<int> currentWave;
+        for(int i = 0; i < dependencies.size(); ++i)
+        {
+            if(waitingCounts.at(i) == 0)
+                currentWave.push_back(i);
+        }
+        
+        int processedCount = 0;
+        while(!currentWave.empty())
+        {
+            std::vector<int> nextWave;
+            for(int i = 0; i < currentWave.size(); ++i)
+            {
+                const std::vector<int>& currentDependents = dependents.at(currentWave.at(i));
+                for(int j = 0; j < currentDependents.size(); ++j)
+                {
+                    if(--waitingCounts.at(currentDependents.at(j)) == 0)
+                        nextWave.push_back(currentDependents.at(j));
+                }
+            }
+            
+            processedCount += currentWave.size();
+            outWaves.push_back(currentWave);
+            currentWave = nextWave;
+        }
+        
+        if(processedCount != dependencies.size())
+        {
+            std::string cycleNames;
+            for(int i = 0; i < dependencies.size(); ++i)
+            {
+                if(waitingCounts.at(i) == 0)
+                    continue;
+                
+                cycleNames += (cycleNames.empty() ? "" : ", ") + dependencies.at(i)->Name;
+            }
+            
+            return DS_ERROR_MSG("Cyclic DependsOn found in dependencies: " + cycleNames);
+        }
+        
+        return {};
+    }
 }
 }
 
@@ -0,0 +1,86 @@
+#ifndef RUNCPP2_DATA_DEPENDENCY_READY_RECORD_HPP
+#define RUNCPP2_DATA_DEPENDENCY_READY_RECORD_HPP
+
+#include "runcpp2/LibYAML_Wrapper.hpp"
+#include "runcpp2/ParseUtil.hpp"
+
+#include "DSResult/DSResult.hpp"
+#include "ssLogger/ssLog.hpp"
+
+#include <string>
+#include <vector>
+
+namespace runcpp2
+{
+namespace Data
+{
+    //NOTE: What a dependency contributed when it was last populated, setup and built, so that it
+    //      doesn't need to be processed again if nothing has changed
+    struct DependencyReadyRecord
+    {
+        //Hash of the profile and the dependency settings, including the setup and build commands
+        std::string Key;
+        std::string Revision;
+        std::vector<std::string> BinariesPaths;
+        
+        inline bool ParseYAML_Node(YAML::ConstNodePtr node)
+        {
+            std::vector<NodeRequirement> requirements =
+            {
+                NodeRequirement("Key", YAML::NodeType::Scalar, true, false),
+                NodeRequirement("Revision", YAML::NodeType::Scalar, true, false),
+                NodeRequirement("BinariesPaths", YAML::NodeType::Sequence, false, true)
+            };
+            
+            if(!CheckNodeRequirements(node, requirements))
+            {
+                ssLOG_ERROR("DependencyReadyRecord: Failed to meet requirements");
+                return false;
+            }
+            
+            Key = node->GetMapValueScalar<std::string>("Key").DS_TRY_ACT(return false);
+            Revision = node->GetMapValueScalar<std::string>("Revision").DS_TRY_ACT(return false);
+            
+            BinariesPaths.clear();
+            if(ExistAndHasChild(node, "BinariesPaths"))
+            {
+                YAML::ConstNodePtr binariesNode = node->GetMapValueNode("BinariesPaths");
+                for(int i = 0; i < binariesNode->GetChildrenCount(); ++i)
+                {
+                    BinariesPaths.push_back(binariesNode->GetSequenceChildScalar<std::string>(i)
+                                                        .DS_TRY_ACT(return false));
+                }
+            }
+            
+            return true;
+        }
+        
+        inline std::string ToString(std::string indentation) const
+        {
+            std::string out;
+            out += indentation + "Key: " + GetEscapedYAMLString(Key) + "\n";
+            out += indentation + "Revision: " + GetEscapedYAMLString(Revision) + "\n";
+            
+            if(BinariesPaths.empty())
+                out += indentation + "BinariesPaths: []\n";
+            else
+            {
+                out += indentation + "BinariesPaths:\n";
+                for(int i = 0; i < BinariesPaths.size(); ++i)
+                    out += indentation + "-   " + GetEscapedYAMLString(BinariesPaths[i]) + "\n";
+            }
+            
+            return out;
+        }
+        
+        inline bool Equals(const DependencyReadyRecord& other) const
+        {
+            return  Key == other.Key &&
+                    Revision == other.Revision &&
+                    BinariesPaths == other.BinariesPaths;
+        }
+    };
+}
+}
+
+#endif
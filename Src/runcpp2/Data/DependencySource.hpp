@@ -1,6 +1,7 @@
 #ifndef RUNCPP2_DATA_DEPENDENCY_SOURCE_HPP
 #define RUNCPP2_DATA_DEPENDENCY_SOURCE_HPP
 
+#include "runcpp2/Data/ArchiveSource.hpp"
 #include "runcpp2/Data/GitSource.hpp"
 #include "runcpp2/Data/LocalSource.hpp"
 #include "runcpp2/ParseUtil.hpp"
@@ -21,7 +22,7 @@ namespace Data
 {
     struct DependencySource
     {
-        mpark::variant<GitSource, LocalSource> Source;
+        mpark::variant<GitSource, LocalSource, ArchiveSource> Source;
         ghc::filesystem::path ImportPath;
         std::vector<std::shared_ptr<DependencySource>> ImportedSources;
         
@@ -41,14 +42,17 @@ namespace Data
                 }
             }
 
+            const int sourcesCount =    static_cast<int>(ExistAndHasChild(node, "Git")) + 
+                                        static_cast<int>(ExistAndHasChild(node, "Local")) +
+                                        static_cast<int>(ExistAndHasChild(node, "Archive"));
+            if(sourcesCount > 1)
+            {
+                ssLOG_ERROR("DependencySource: Only one of Git, Local and Archive can exist");
+                return false;
+            }
+            
             if(ExistAndHasChild(node, "Git"))
             {
-                if(ExistAndHasChild(node, "Local"))
-                {
-                    ssLOG_ERROR("DependencySource: Both Git and Local sources found");
-                    return false;
-                }
-                
                 GitSource gitSource;
                 YAML::ConstNodePtr gitNode = node->GetMapValueNode("Git");
                 if(!gitSource.ParseYAML_Node(gitNode))
@@ -58,12 +62,6 @@ namespace Data
             }
             else if(ExistAndHasChild(node, "Local"))
             {
-                if(ExistAndHasChild(node, "Git"))
-                {
-                    ssLOG_ERROR("DependencySource: Both Git and Local sources found");
-                    return false;
-                }
-                
                 LocalSource localSource;
                 YAML::ConstNodePtr localNode = node->GetMapValueNode("Local");
                 if(!localSource.ParseYAML_Node(localNode))
@@ -71,6 +69,15 @@ namespace Data
                 Source = localSource;
                 return true;
             }
+            else if(ExistAndHasChild(node, "Archive"))
+            {
+                ArchiveSource archiveSource;
+                YAML::ConstNodePtr archiveNode = node->GetMapValueNode("Archive");
+                if(!archiveSource.ParseYAML_Node(archiveNode))
+                    return false;
+                Source = archiveSource;
+                return true;
+            }
             //If no source is found, we need to check if it's an imported source. 
             //If so, we assume it's a local source with path "./"
             else if(!ImportPath.empty())
@@ -81,7 +88,7 @@ namespace Data
                 return true;
             }
             
-            ssLOG_ERROR("DependencySource: Neither Git nor Local source found");
+            ssLOG_ERROR("DependencySource: None of Git, Local and Archive sources found");
             return false;
         }
 
@@ -101,6 +108,11 @@ namespace Data
                 const LocalSource* local = mpark::get_if<LocalSource>(&Source);
                 out += local->ToString(indentation);
             }
+            else if(mpark::get_if<ArchiveSource>(&Source))
+            {
+                const ArchiveSource* archive = mpark::get_if<ArchiveSource>(&Source);
+                out += archive->ToString(indentation);
+            }
             else
             {
                 ssLOG_ERROR("Invalid DependencySource type");
@@ -136,6 +148,17 @@ namespace Data
                 else
                     return false;
             }
+            else if(mpark::get_if<ArchiveSource>(&Source))
+            {
+                if(mpark::get_if<ArchiveSource>(&other.Source))
+                {
+                    const ArchiveSource* archive = mpark::get_if<ArchiveSource>(&Source);
+                    const ArchiveSource* otherArchive = mpark::get_if<ArchiveSource>(&other.Source);
+                    return archive->Equals(*otherArchive);
+                }
+                else
+                    return false;
+            }
             
             ssLOG_ERROR("Invalid DependencySource type");
             return false;
@@ -22,6 +22,13 @@ namespace Data
         bool FullHistory = false;
         SubmoduleInitType CurrentSubmoduleInitType = SubmoduleInitType::SHALLOW;
         
+        //Clones without the file contents, which are only downloaded when checked out
+        bool PartialClone = false;
+        
+        //Only checks out the include paths of the dependency and the extra paths
+        bool SparseCheckout = false;
+        std::vector<std::string> SparseCheckoutPaths;
+        
         inline bool ParseYAML_Node(YAML::ConstNodePtr node)
         {
             std::vector<NodeRequirement> requirements =
@@ -29,7 +36,10 @@ namespace Data
                 NodeRequirement("URL", YAML::NodeType::Scalar, true, false),
                 NodeRequirement("Branch", YAML::NodeType::Scalar, false, false),
                 NodeRequirement("FullHistory", YAML::NodeType::Scalar, false, false),
-                NodeRequirement("SubmoduleInitType", YAML::NodeType::Scalar, false, false)
+                NodeRequirement("SubmoduleInitType", YAML::NodeType::Scalar, false, false),
+                NodeRequirement("PartialClone", YAML::NodeType::Scalar, false, false),
+                NodeRequirement("SparseCheckout", YAML::NodeType::Scalar, false, false),
+                NodeRequirement("SparseCheckoutPaths", YAML::NodeType::Sequence, false, true)
             };
             
             if(!CheckNodeRequirements(node, requirements))
@@ -60,6 +70,26 @@ namespace Data
                     return false;
                 }
             }
+            if(ExistAndHasChild(node, "PartialClone"))
+            {
+                PartialClone = node ->GetMapValueScalar<bool>("PartialClone")
+                                    .DS_TRY_ACT(return false);
+            }
+            if(ExistAndHasChild(node, "SparseCheckout"))
+            {
+                SparseCheckout = node   ->GetMapValueScalar<bool>("SparseCheckout")
+                                        .DS_TRY_ACT(return false);
+            }
+            if(ExistAndHasChild(node, "SparseCheckoutPaths"))
+            {
+                YAML::ConstNodePtr pathsNode = node->GetMapValueNode("SparseCheckoutPaths");
+                for(int i = 0; i < pathsNode->GetChildrenCount(); ++i)
+                {
+                    std::string path = pathsNode->GetSequenceChildScalar<std::string>(i)
+                                                .DS_TRY_ACT(return false);
+                    SparseCheckoutPaths.push_back(path);
+                }
+            }
             
             return true;
         }
@@ -76,6 +106,20 @@ namespace Data
                     "    SubmoduleInitType: " + 
                     SubmoduleInitTypeToString(CurrentSubmoduleInitType) + 
                     "\n";
+            out += indentation + "    PartialClone: " + (PartialClone ? "true" : "false") + "\n";
+            out +=  indentation + "    SparseCheckout: " + (SparseCheckout ? "true" : "false") + 
+                    "\n";
+            if(SparseCheckoutPaths.empty())
+                out += indentation + "    SparseCheckoutPaths: []\n";
+            else
+            {
+                out += indentation + "    SparseCheckoutPaths:\n";
+                for(int i = 0; i < SparseCheckoutPaths.size(); ++i)
+                {
+                    out +=  indentation + "    -   " + 
+                            GetEscapedYAMLString(SparseCheckoutPaths[i]) + "\n";
+                }
+            }
             return out;
         }
 
@@ -84,7 +128,10 @@ namespace Data
             return  URL == other.URL && 
                     Branch == other.Branch && 
                     FullHistory == other.FullHistory &&
-                    CurrentSubmoduleInitType == other.CurrentSubmoduleInitType;
+                    CurrentSubmoduleInitType == other.CurrentSubmoduleInitType &&
+                    PartialClone == other.PartialClone &&
+                    SparseCheckout == other.SparseCheckout &&
+                    SparseCheckoutPaths == other.SparseCheckoutPaths;
         }
     };
 }
@@ -121,6 +121,7 @@ namespace Data
             INTERN_ADD_MAP("{Stage.Input.Source.Object.Path}");
             INTERN_ADD_MAP("{Stage.Input.Shared.Path}");
             INTERN_ADD_MAP("{Stage.Input.Static.Path}");
+            INTERN_ADD_MAP("{Stage.RPath}");
             INTERN_ADD_MAP("{/}");
             
             #undef INTERN_ADD_MAP
@@ -47,7 +47,11 @@ namespace Data
         std::unordered_map<PlatformName, ProfilesFlagsOverride> OverrideCompileFlags;
         std::unordered_map<PlatformName, ProfilesFlagsOverride> OverrideLinkFlags;
         std::unordered_map<PlatformName, ProfilesProcessPaths> OtherFilesToBeCompiled;
+        bool UnityBuild = false;
+        std::unordered_map<PlatformName, ProfilesProcessPaths> UnityExcludedSourceFiles;
         std::unordered_map<PlatformName, ProfilesProcessPaths> IncludePaths;
+        bool PruneDependencyIncludePaths = false;
+        bool SharedDependenciesRPath = false;
         std::vector<DependencyInfo> Dependencies;
         std::unordered_map<PlatformName, ProfilesDefines> Defines;
         std::unordered_map<PlatformName, ProfilesCommands> Setup;
@@ -96,6 +100,9 @@ namespace Data
             {
                 NodeRequirement("PassScriptPath", YAML::NodeType::Scalar, false, true),
                 NodeRequirement("Language", YAML::NodeType::Scalar, false, true),
+                NodeRequirement("UnityBuild", YAML::NodeType::Scalar, false, true),
+                NodeRequirement("PruneDependencyIncludePaths", YAML::NodeType::Scalar, false, true),
+                NodeRequirement("SharedDependenciesRPath", YAML::NodeType::Scalar, false, true),
                 NodeRequirement("BuildType", YAML::NodeType::Scalar, false, true),
                 NodeRequirement("RequiredProfiles", YAML::NodeType::Map, false, true),
                 
@@ -106,6 +113,7 @@ namespace Data
                 NodeRequirement("OverrideLinkFlags", YAML::NodeType::Map, false, true),
                 
                 //OtherFilesToBeCompiled can be platform profile map or sequence of paths, handle later
+                //UnityExcludedSourceFiles can be platform profile map or sequence of paths, handle later
                 //IncludePaths can be platform profile map or sequence of paths, handle later
                 
                 NodeRequirement("Dependencies", YAML::NodeType::Sequence, false, true)
@@ -139,6 +147,64 @@ namespace Data
                 }
             }
             
+            if(ExistAndHasChild(clonedNode, "UnityBuild"))
+            {
+                std::string unityBuildStr = 
+                    clonedNode->GetMapValueScalar<std::string>("UnityBuild").DS_TRY();
+                for(size_t i = 0; i < unityBuildStr.length(); ++i)
+                    unityBuildStr[i] = std::tolower(unityBuildStr[i]);
+                
+                if(unityBuildStr == "true" || unityBuildStr == "1")
+                    UnityBuild = true;
+                else if(unityBuildStr == "false" || unityBuildStr == "0")
+                    UnityBuild = false;
+                else
+                {
+                    return DS_ERROR_MSG("ScriptInfo: Invalid value for UnityBuild: " + 
+                                        unityBuildStr + "\n" +
+                                        "Expected true/false or 1/0");
+                }
+            }
+            
+            if(ExistAndHasChild(clonedNode, "PruneDependencyIncludePaths"))
+            {
+                std::string pruneStr = 
+                    clonedNode  ->GetMapValueScalar<std::string>("PruneDependencyIncludePaths")
+                                .DS_TRY();
+                for(size_t i = 0; i < pruneStr.length(); ++i)
+                    pruneStr[i] = std::tolower(pruneStr[i]);
+                
+                if(pruneStr == "true" || pruneStr == "1")
+                    PruneDependencyIncludePaths = true;
+                else if(pruneStr == "false" || pruneStr == "0")
+                    PruneDependencyIncludePaths = false;
+                else
+                {
+                    return DS_ERROR_MSG("ScriptInfo: Invalid value for "
+                                        "PruneDependencyIncludePaths: " + pruneStr + "\n" +
+                                        "Expected true/false or 1/0");
+                }
+            }
+            
+            if(ExistAndHasChild(clonedNode, "SharedDependenciesRPath"))
+            {
+                std::string rpathStr = 
+                    clonedNode->GetMapValueScalar<std::string>("SharedDependenciesRPath").DS_TRY();
+                for(size_t i = 0; i < rpathStr.length(); ++i)
+                    rpathStr[i] = std::tolower(rpathStr[i]);
+                
+                if(rpathStr == "true" || rpathStr == "1")
+                    SharedDependenciesRPath = true;
+                else if(rpathStr == "false" || rpathStr == "0")
+                    SharedDependenciesRPath = false;
+                else
+                {
+                    return DS_ERROR_MSG("ScriptInfo: Invalid value for SharedDependenciesRPath: " + 
+                                        rpathStr + "\n" +
+                                        "Expected true/false or 1/0");
+                }
+            }
+            
             if(ExistAndHasChild(clonedNode, "Language"))
             {
                 Language = clonedNode->GetMapValueScalar<std::string>("Language").DS_TRY();
@@ -191,6 +257,10 @@ namespace Data
                                                                             "SourceFiles", 
                                                                             OtherFilesToBeCompiled, 
                                                                             "SourceFiles"));
+            DS_ASSERT_TRUE(ParsePlatformProfileMap<ProfilesProcessPaths>(   clonedNode, 
+                                                                            "UnityExcludedSourceFiles", 
+                                                                            UnityExcludedSourceFiles, 
+                                                                            "UnityExcludedSourceFiles"));
             DS_ASSERT_TRUE(ParsePlatformProfileMap<ProfilesProcessPaths>(   clonedNode, 
                                                                             "IncludePaths", 
                                                                             IncludePaths, 
@@ -211,6 +281,19 @@ namespace Data
                     );
                     Dependencies.push_back(info);
                 }
+                
+                //Check for cyclic DependsOn early
+                std::vector<const DependencyInfo*> dependenciesToCheck;
+                for(int i = 0; i < Dependencies.size(); ++i)
+                    dependenciesToCheck.push_back(&Dependencies.at(i));
+                
+                std::vector<std::vector<int>> dependenciesWaves;
+                GetDependenciesWaves(dependenciesToCheck, dependenciesWaves).DS_TRY_ACT
+                (
+                    DS_TMP_ERROR.Message += "\nScriptInfo: Invalid DependsOn in Dependencies";
+                    DS_APPEND_TRACE(DS_TMP_ERROR);
+                    return DS::Error(DS_TMP_ERROR)
+                );
             }
             
             DS_ASSERT_TRUE(ParsePlatformProfileMap<ProfilesDefines>(clonedNode, 
@@ -319,6 +402,20 @@ namespace Data
                     out += it->second.ToString(indentation + "        ");
                 }
             }
+            
+            out += indentation + "UnityBuild: " + (UnityBuild ? "true" : "false") + "\n";
+            
+            if(!UnityExcludedSourceFiles.empty())
+            {
+                out += indentation + "UnityExcludedSourceFiles:\n";
+                for(auto it = UnityExcludedSourceFiles.begin(); 
+                    it != UnityExcludedSourceFiles.end(); 
+                    ++it)
+                {
+                    out += indentation + "    " + it->first + ":\n";
+                    out += it->second.ToString(indentation + "        ");
+                }
+            }
 
             if(!IncludePaths.empty())
             {
@@ -330,6 +427,11 @@ namespace Data
                 }
             }
             
+            out +=  indentation + "PruneDependencyIncludePaths: " + 
+                    (PruneDependencyIncludePaths ? "true" : "false") + "\n";
+            out +=  indentation + "SharedDependenciesRPath: " + 
+                    (SharedDependenciesRPath ? "true" : "false") + "\n";
+            
             if(!Dependencies.empty())
             {
                 out += indentation + "Dependencies:\n";
@@ -486,6 +588,9 @@ namespace Data
         {
             if( Language != other.Language || 
                 PassScriptPath != other.PassScriptPath ||
+                UnityBuild != other.UnityBuild ||
+                PruneDependencyIncludePaths != other.PruneDependencyIncludePaths ||
+                SharedDependenciesRPath != other.SharedDependenciesRPath ||
                 CurrentBuildType != other.CurrentBuildType ||
                 RequiredProfiles.size() != other.RequiredProfiles.size() ||
                 Parameters.size() != other.Parameters.size() ||
@@ -493,6 +598,7 @@ namespace Data
                 OverrideCompileFlags.size() != other.OverrideCompileFlags.size() ||
                 OverrideLinkFlags.size() != other.OverrideLinkFlags.size() ||
                 OtherFilesToBeCompiled.size() != other.OtherFilesToBeCompiled.size() ||
+                UnityExcludedSourceFiles.size() != other.UnityExcludedSourceFiles.size() ||
                 IncludePaths.size() != other.IncludePaths.size() ||
                 Dependencies.size() != other.Dependencies.size() ||
                 Defines.size() != other.Defines.size() ||
@@ -559,6 +665,15 @@ namespace Data
                 }
             }
 
+            for(const auto& it : UnityExcludedSourceFiles)
+            {
+                if( other.UnityExcludedSourceFiles.count(it.first) == 0 || 
+                    !other.UnityExcludedSourceFiles.at(it.first).Equals(it.second))
+                {
+                    return false;
+                }
+            }
+
             for(const auto& it : IncludePaths)
             {
                 if( other.IncludePaths.count(it.first) == 0 || 
@@ -73,6 +73,9 @@ namespace Data
         std::unordered_map<PlatformName, std::string> PreRun;
         std::unordered_map<PlatformName, std::string> CheckExistence;
         
+        //Flag for searching shared libraries in {Stage.RPath} at runtime, only used by the linker
+        std::unordered_map<PlatformName, std::string> RPathFlag;
+        
         struct 
         {
             std::unordered_map<PlatformName, OutputTypeInfo> Executable;
@@ -166,6 +169,7 @@ namespace Data
             {
                 NodeRequirement("PreRun", YAML::NodeType::Map, false, true),
                 NodeRequirement("CheckExistence", YAML::NodeType::Map, true, false),
+                NodeRequirement("RPathFlag", YAML::NodeType::Map, false, true),
                 NodeRequirement(outputTypeKeyName, YAML::NodeType::Map, true, false)
             };
 
@@ -201,6 +205,19 @@ namespace Data
                 }
             }
             
+            if(ExistAndHasChild(node, "RPathFlag"))
+            {
+                YAML::ConstNodePtr rpathFlagNode = node->GetMapValueNode("RPathFlag");
+                for(int i = 0; i < rpathFlagNode->GetChildrenCount(); ++i)
+                {
+                    std::string key = rpathFlagNode ->GetMapKeyScalarAt<std::string>(i)
+                                                    .DS_TRY_ACT(return false);
+                    std::string value = rpathFlagNode   ->GetMapValueScalarAt<std::string>(i)
+                                                        .DS_TRY_ACT(return false);
+                    RPathFlag[key] = value;
+                }
+            }
+            
             //OutputTypes
             {
                 if(!ExistAndHasChild(node, outputTypeKeyName))
@@ -288,6 +305,16 @@ namespace Data
                         GetEscapedYAMLString(it->second) + "\n";
             }
             
+            if(!RPathFlag.empty())
+            {
+                out += indentation + "RPathFlag:\n";
+                for(auto it = RPathFlag.begin(); it != RPathFlag.end(); ++it)
+                {
+                    out +=  indentation + "    " + it->first + ": " + 
+                            GetEscapedYAMLString(it->second) + "\n";
+                }
+            }
+            
             out += indentation + outputTypeKeyName + ":\n";
             
             out += indentation + "    Executable: \n";
@@ -305,7 +332,8 @@ namespace Data
         inline bool Equals(const StageInfo& other) const
         {
             if( PreRun.size() != other.PreRun.size() ||
-                CheckExistence.size() != other.CheckExistence.size())
+                CheckExistence.size() != other.CheckExistence.size() ||
+                RPathFlag.size() != other.RPathFlag.size())
             {
                 return false;   
             }
@@ -324,6 +352,15 @@ namespace Data
                     return false;
                 }
             }
+            
+            for(const auto& it : RPathFlag)
+            {
+                if( other.RPathFlag.count(it.first) == 0 || 
+                    other.RPathFlag.at(it.first) != it.second)
+                {
+                    return false;
+                }
+            }
 
             auto compareOutputTypeInfoMaps = 
                 []( const std::unordered_map<PlatformName, OutputTypeInfo>& a,
@@ -1,11 +1,14 @@
 #ifndef RUNCPP2_DEPENDENCIES_SETUP_HELPER_HPP
 #define RUNCPP2_DEPENDENCIES_SETUP_HELPER_HPP
 
+#include "runcpp2/Data/ArchiveSource.hpp"
+#include "runcpp2/Data/DependenciesLock.hpp"
 #include "runcpp2/Data/DependencyInfo.hpp"
 #include "runcpp2/Data/ScriptInfo.hpp"
 #include "runcpp2/Data/Profile.hpp"
 #include "runcpp2/Data/DependencyLibraryType.hpp"
 #include "runcpp2/Data/DependencyLinkProperty.hpp"
+#include "runcpp2/Data/DependencyReadyRecord.hpp"
 #include "runcpp2/Data/DependencySource.hpp"
 #include "runcpp2/Data/FileProperties.hpp"
 #include "runcpp2/Data/FilesToCopyInfo.hpp"
@@ -16,10 +19,13 @@
 #include "runcpp2/Data/ProfilesCommands.hpp"
 #include "runcpp2/Data/SubmoduleInitType.hpp"
 
+#include "runcpp2/ConfigParsing.hpp"
+#include "runcpp2/HashUtil.hpp"
 #include "runcpp2/LibYAML_Wrapper.hpp"
 #include "runcpp2/PlatformUtil.hpp"
 #include "runcpp2/StringUtil.hpp"
 #include "runcpp2/DeferUtil.hpp"
+#include "runcpp2/JobPool.hpp"
 
 #if !defined(NOMINMAX)
     #define NOMINMAX 1
@@ -30,6 +36,9 @@
 #include "ghc/filesystem.hpp"
 #include "mpark/variant.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <random>
 #include <vector>
 #include <unordered_set>
 #include <future>
@@ -37,6 +46,7 @@
 #include <stddef.h>
 #include <cctype>
 #include <fstream>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -51,10 +61,40 @@ namespace
                                         ghc::filesystem::path& outCopyPath,
                                         ghc::filesystem::path& outSourcePath);
     
+    bool GetUserCacheDirectory(const std::string& name, ghc::filesystem::path& outDirectory);
+    
+    ghc::filesystem::path GetTemporaryPath(const ghc::filesystem::path& path);
+    
+    std::string GetArchiveName(const ghc::filesystem::path& archivePath);
+    
+    DS::Result<void> ExtractArchiveIfNeeded(const runcpp2::Data::ArchiveSource& archive,
+                                            const ghc::filesystem::path& archivePath,
+                                            const ghc::filesystem::path& extractedPath);
+    
+    bool RunGitCommand(const std::string& command, const ghc::filesystem::path& runDirectory);
+    
+    bool HasGitCommit(const ghc::filesystem::path& repoPath, const std::string& revision);
+    
+    bool GetSparseCheckoutPaths(const runcpp2::Data::DependencyInfo& dependency,
+                                const runcpp2::Data::GitSource& git,
+                                std::vector<std::string>& outPaths);
+    
+    std::string GetSparseCheckoutCommand(const std::vector<std::string>& sparsePaths);
+    
+    bool IsGitCopyValid(const ghc::filesystem::path& copyPath, const bool checkObjects);
+    
+    bool CloneFromGitMirror(const runcpp2::Data::GitSource& git,
+                            const ghc::filesystem::path& copyPath,
+                            const ghc::filesystem::path& buildDir,
+                            const ghc::filesystem::path& mirrorsDir,
+                            const std::string& lockedRevision,
+                            const std::vector<std::string>& sparsePaths);
+    
     DS::Result<void> PopulateLocalDependency(   const runcpp2::Data::DependencyInfo& dependency,
                                                 const ghc::filesystem::path& copyPath,
                                                 const ghc::filesystem::path& sourcePath,
                                                 const ghc::filesystem::path& buildDir,
+                                                const std::string& lockedRevision,
                                                 bool& outPrePopulated);
     
     DS::Result<void> 
@@ -62,6 +102,7 @@ namespace
                                 const std::vector<std::string>& dependenciesCopiesPaths,
                                 const std::vector<std::string>& dependenciesSourcesPaths,
                                 const ghc::filesystem::path& buildDir,
+                                const runcpp2::Data::DependenciesLock& lock,
                                 std::vector<bool>& outPrePopulated);
     
     DS::Result<void> 
@@ -74,13 +115,91 @@ namespace
                                                         runcpp2::Data::ProfilesCommands> steps,
                             const std::string& dependenciesCopiedDirectory,
                             bool required,
-                            bool redirectIO);
+                            bool redirectIO,
+                            const runcpp2::Jobserver* jobserver);
 
     bool GetDependencyBinariesExtensionsToLink( const runcpp2::Data::DependencyInfo& dependencyInfo,
                                                 const runcpp2::Data::Profile& profile,
                                                 std::vector<std::string>& outExtensionsToLink);
 
     ghc::filesystem::path ResolveSymlink(const ghc::filesystem::path& path, std::error_code& ec);
+    
+    //Files in a library search directory, grouped by their extensions
+    using SearchDirectoryIndex = 
+        std::unordered_map<std::string, std::vector<ghc::filesystem::path>>;
+    
+    const SearchDirectoryIndex& 
+    GetSearchDirectoryIndex(const std::string& searchDirectory,
+                            std::unordered_map<std::string, SearchDirectoryIndex>& inOutIndices);
+    
+    bool ReadSyncManifest(  const ghc::filesystem::path& manifestPath,
+                            std::unordered_map<std::string, std::string>& outEntries);
+    
+    bool WriteSyncManifest( const ghc::filesystem::path& manifestPath,
+                            const std::unordered_map<std::string, std::string>& entries);
+    
+    DS::Result<void> 
+    SyncLocalFile(  runcpp2::Data::LocalCopyMode copyMode,
+                    const ghc::filesystem::path& srcPath,
+                    const ghc::filesystem::path& targetPath,
+                    const std::string& relativePath,
+                    const std::unordered_map<std::string, std::string>& lastManifest,
+                    std::unordered_map<std::string, std::string>& inOutNewManifest);
+    
+    bool GetSyncFileKey(const ghc::filesystem::path& srcPath, std::string& outKey);
+    
+    DS::Result<void> 
+    AddToSyncManifest(  const ghc::filesystem::path& srcPath,
+                        const ghc::filesystem::path& sourcePath,
+                        std::unordered_map<std::string, std::string>& inOutManifest);
+    
+    std::string 
+    GetSyncManifestRevision(const std::unordered_map<std::string, std::string>& manifest);
+    
+    bool GetDependencyRevision( const runcpp2::Data::DependencyInfo& dependency,
+                                const ghc::filesystem::path& copyPath,
+                                std::string& outRevision);
+    
+    bool GetRemoteGitRevision(const runcpp2::Data::GitSource& git, std::string& outRevision);
+    
+    void GetScriptDependenciesLock( const runcpp2::Data::ScriptInfo& scriptInfo,
+                                    const runcpp2::Data::DependenciesLock& lock,
+                                    runcpp2::Data::DependenciesLock& outScriptLock);
+    
+    bool GetDependencyLockSource(   const runcpp2::Data::DependencyInfo& dependency, 
+                                    std::string& outSource);
+    
+    const std::string* GetLockedRevision(   const runcpp2::Data::DependenciesLock& lock,
+                                            const runcpp2::Data::DependencyInfo& dependency);
+    
+    bool GetDependencyCacheKey( const runcpp2::Data::Profile& profile,
+                                const runcpp2::Data::DependencyInfo& dependency,
+                                const std::string& revision,
+                                std::string& outCacheKey);
+    
+    std::string GetDependencyReadyKey(  const runcpp2::Data::Profile& profile,
+                                        const runcpp2::Data::DependencyInfo& dependency);
+    
+    void 
+    ReadDependenciesReadyRecords(   const ghc::filesystem::path& buildDir,
+                                    std::map<   std::string, 
+                                                runcpp2::Data::DependencyReadyRecord>& outRecords);
+    
+    bool RestoreDependencyArtifacts(const std::string& cacheKey, 
+                                    const ghc::filesystem::path& copyPath);
+    
+    bool StoreDependencyArtifacts(  const runcpp2::Data::Profile& profile,
+                                    runcpp2::Data::DependencyInfo& dependency,
+                                    const ghc::filesystem::path& copyPath,
+                                    const std::string& cacheKey);
+    
+    DS::Result<void> 
+    WaitForDependenciesJobs(std::vector<std::future<DS::Result<void>>>& actions,
+                            const std::string& stepName);
+    
+    DS::Result<void> 
+    GetAvailableDependenciesWaves(  const std::vector<runcpp2::Data::DependencyInfo*>& dependencies,
+                                    std::vector<std::vector<int>>& outWaves);
 }
 
 namespace runcpp2
@@ -194,7 +313,8 @@ namespace runcpp2
                                                                 availableDependencies.at(i)->Cleanup, 
                                                                 dependenciesLocalCopiesPaths.at(i),
                                                                 false,
-                                                                false);
+                                                                false,
+                                                                nullptr);
             if(!depResult.HasValue())
             {
                 depResult.Error().Message +=    "\nFailed to cleanup dependency " + 
@@ -232,7 +352,8 @@ namespace runcpp2
                                 std::vector<Data::DependencyInfo*>& availableDependencies,
                                 const std::vector<std::string>& dependenciesLocalCopiesPaths,
                                 const std::vector<std::string>& dependenciesSourcePaths,
-                                const int maxThreads)
+                                const Data::DependenciesLock& lock,
+                                JobPool& jobPool)
     {
         ssLOG_FUNC_INFO();
 
@@ -242,124 +363,88 @@ namespace runcpp2
 
         std::vector<bool> prePolulatedDependencies;
         
-        //Clone/copy the dependencies if needed
+        //Clone/copy the dependencies if needed, git dependencies are checked out at the locked 
+        //revisions if there's any
         PopulateLocalDependencies(  availableDependencies, 
                                     dependenciesLocalCopiesPaths, 
                                     dependenciesSourcePaths, 
                                     buildDir,
+                                    lock,
                                     prePolulatedDependencies).DS_TRY();
         
         PopulateAbsoluteIncludePaths(availableDependencies, dependenciesLocalCopiesPaths).DS_TRY();
         
-        #if RUNCPP2_USE_PARALLEL_FOR_DEP
-        std::vector<std::future<DS::Result<void>>> actions;
-        std::vector<bool> finished;
+        //NOTE: Setup commands are running in parallel, capture the output when there's more than
+        //      one worker so that each dependency's output is logged together instead of interleaved
+        const bool captureSetupOutput = jobPool.GetMaxThreads() > 1;
+        const Jobserver* jobserver = jobPool.GetJobserver();
         
-        //Cache logs for worker threads
-        ssLOG_ENABLE_CACHE_OUTPUT_FOR_NEW_THREADS();
-        int logLevel = ssLOG_GET_CURRENT_THREAD_TARGET_LEVEL();
-        #endif
+        //Dependencies in the same wave are independent of each other and can be setup together
+        std::vector<std::vector<int>> dependenciesWaves;
+        GetAvailableDependenciesWaves(availableDependencies, dependenciesWaves).DS_TRY();
         
         //Run setup steps
-        for(int i = 0; i < availableDependencies.size(); ++i)
+        for(int waveIndex = 0; waveIndex < dependenciesWaves.size(); ++waveIndex)
         {
-            //Don't run setup if the dependency is already setup in previous runs
-            if(prePolulatedDependencies.at(i))
-            {
-                ssLOG_INFO("Skip running setup commands for " << availableDependencies.at(i)->Name);
-                continue;
-            }
-            
-            #if RUNCPP2_USE_PARALLEL_FOR_DEP
-            actions.emplace_back
-            (
-                std::async
-                (
-                    std::launch::async,
-                    [
-                        i, 
-                        &profile, 
-                        &availableDependencies, 
-                        &dependenciesLocalCopiesPaths, 
-                        logLevel
-                    ]() -> DS::Result<void>
-                    {
-                        ssLOG_SET_CURRENT_THREAD_TARGET_LEVEL(logLevel);
-            #endif
-                        ssLOG_INFO("Running setup commands for " << availableDependencies.at(i)->Name);
-                        DS::Result<void> depResult = 
-                            RunDependenciesSteps(   profile, 
-                                                    availableDependencies.at(i)->Setup, 
-                                                    dependenciesLocalCopiesPaths.at(i),
-                                                    true,
-                                                    false);
-                        if(!depResult.HasValue())
-                        {
-                            depResult.Error().Message +=    "\nFailed to setup dependency " + 
-                                                            availableDependencies.at(i)->Name;
-                            DS_APPEND_TRACE(depResult.Error());
-                            return depResult;
-                        }
-            
-            #if RUNCPP2_USE_PARALLEL_FOR_DEP
-                        return {};
-                    }
-                )
-            );
-            
-            finished.emplace_back(false);
+            const std::vector<int>& currentWave = dependenciesWaves.at(waveIndex);
+            std::vector<std::future<DS::Result<void>>> actions;
             
-            //Evaluate the setup results for each batch
-            if(actions.size() >= maxThreads || i == availableDependencies.size() - 1)
+            for(int waveDepIndex = 0; waveDepIndex < currentWave.size(); ++waveDepIndex)
             {
-                bool needsWaiting = false;
-                do
+                const int i = currentWave.at(waveDepIndex);
+                
+                //Don't run setup if the dependency is already setup in previous runs
+                if(prePolulatedDependencies.at(i))
                 {
-                    std::chrono::system_clock::time_point deadline = 
-                        std::chrono::system_clock::now() + std::chrono::seconds(30);
-                    needsWaiting = false;
-                    for(int j = 0; j < actions.size(); ++j)
-                    {
-                        if(finished.at(j))
-                            continue;
-                        
-                        if(!actions.at(j).valid())
-                        {
-                            ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                            return DS_ERROR_MSG("Failed to construct actions for setup");
-                        }
-                        
-                        std::future_status actionStatus = actions.at(j).wait_until(deadline);
-                        if(actionStatus == std::future_status::ready)
+                    ssLOG_INFO("Skip running setup commands for " << 
+                                availableDependencies.at(i)->Name);
+                    continue;
+                }
+                
+                actions.emplace_back
+                (
+                    jobPool.AddJob<DS::Result<void>>
+                    (
+                        [
+                            i, 
+                            &profile, 
+                            &availableDependencies, 
+                            &dependenciesLocalCopiesPaths, 
+                            captureSetupOutput,
+                            jobserver
+                        ]() -> DS::Result<void>
                         {
-                            DS::Result<void> actionResult = actions.at(j).get();
-                            if(!actionResult.HasValue())
+                            ssLOG_INFO("Running setup commands for " << 
+                                        availableDependencies.at(i)->Name);
+                            DS::Result<void> depResult = 
+                                RunDependenciesSteps(   profile, 
+                                                        availableDependencies.at(i)->Setup, 
+                                                        dependenciesLocalCopiesPaths.at(i),
+                                                        true,
+                                                        captureSetupOutput,
+                                                        jobserver);
+                            if(!depResult.HasValue())
                             {
-                                ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                                actionResult.Error().Message += "\nSetup failed for dependencies";
-                                DS_APPEND_TRACE(actionResult.Error());
-                                return actionResult;
+                                depResult.Error().Message +=    "\nFailed to setup dependency " + 
+                                                                availableDependencies.at(i)->Name;
+                                DS_APPEND_TRACE(depResult.Error());
+                                return depResult;
                             }
-                            finished.at(j) = true;
-                        }
-                        else
-                        {
-                            ssLOG_WARNING("Manual interrupt might be needed");
-                            ssLOG_WARNING("Waited 30 seconds, dependencies setup still going...");
-                            needsWaiting = true;
+                            
+                            ssLOG_INFO("Finished setup commands for " << 
+                                        availableDependencies.at(i)->Name);
+                            return {};
                         }
-                    }
-                }
-                while(needsWaiting);
-                
-                actions.clear();
-                finished.clear();
+                    )
+                );
             }
             
-            #endif //#if RUNCPP2_USE_PARALLEL_FOR_DEP
+            //Evaluate the setup results after all of them in this wave are finished
+            DS::Result<void> setupResult = WaitForDependenciesJobs(actions, "setup");
+            ssLOG_OUTPUT_ALL_CACHE_GROUPED();
+            setupResult.DS_TRY();
         }
         
-        ssLOG_OUTPUT_ALL_CACHE_GROUPED();
         return {};
     }
 
@@ -369,7 +454,8 @@ namespace runcpp2
                         const Data::ScriptInfo& scriptInfo,
                         const std::vector<Data::DependencyInfo*>& availableDependencies,
                         const std::vector<std::string>& dependenciesLocalCopiesPaths,
-                        const int maxThreads)
+                        const std::vector<std::string>& dependenciesRevisions,
+                        JobPool& jobPool)
     {
         ssLOG_FUNC_INFO();
 
@@ -377,123 +463,143 @@ namespace runcpp2
         if(!scriptInfo.Populated)
             return {};
         
-        #if RUNCPP2_USE_PARALLEL_FOR_DEP
-        std::vector<std::future<bool>> actions;
-        std::vector<bool> finished;
+        const Jobserver* jobserver = jobPool.GetJobserver();
         
-        //Cache logs for worker threads
-        ssLOG_ENABLE_CACHE_OUTPUT_FOR_NEW_THREADS();
-        int logLevel = ssLOG_GET_CURRENT_THREAD_TARGET_LEVEL();
-        #endif
+        //Dependencies in the same wave are independent of each other and can be built together
+        std::vector<std::vector<int>> dependenciesWaves;
+        GetAvailableDependenciesWaves(availableDependencies, dependenciesWaves).DS_TRY();
         
-        //Run build steps
-        for(int i = 0; i < availableDependencies.size(); ++i)
+        //Run build steps, each dependency is built by one of the workers
+        for(int waveIndex = 0; waveIndex < dependenciesWaves.size(); ++waveIndex)
         {
-            ssLOG_INFO("Running build commands for " << availableDependencies.at(i)->Name);
-            
-            #if RUNCPP2_USE_PARALLEL_FOR_DEP
-            actions.emplace_back
-            (
-                std::async
-                (
-                    std::launch::async,
-                    [
-                        i, 
-                        &profile, 
-                        &availableDependencies, 
-                        &dependenciesLocalCopiesPaths, 
-                        logLevel
-                    ]() -> DS::Result<void>
-                    {
-                        ssLOG_SET_CURRENT_THREAD_TARGET_LEVEL(logLevel);
-            #endif
-                        DS::Result<void> depResult = 
-                            RunDependenciesSteps(   profile, 
-                                                    availableDependencies.at(i)->Build, 
-                                                    dependenciesLocalCopiesPaths.at(i),
-                                                    true,
-                                                    true);  //TODO: Make this (and others) 
-                                                            //      configurable later
-                        if(!depResult.HasValue())
-                        {
-                            depResult.Error().Message +=    "\nFailed to build dependency " + 
-                                                            availableDependencies.at(i)->Name;
-                            DS_APPEND_TRACE(depResult.Error());
-                            return depResult;
-                        }
-            #if RUNCPP2_USE_PARALLEL_FOR_DEP
-                        return {};
-                    }
-                )
-            );
-            
-            finished.emplace_back(false);
+            const std::vector<int>& currentWave = dependenciesWaves.at(waveIndex);
+            std::vector<std::future<DS::Result<void>>> actions;
             
-            //Evaluate the build results for each batch
-            if(actions.size() >= maxThreads || i == availableDependencies.size() - 1)
+            for(int waveDepIndex = 0; waveDepIndex < currentWave.size(); ++waveDepIndex)
             {
-                bool needsWaiting = false;
-                do
-                {
-                    std::chrono::system_clock::time_point deadline = 
-                        std::chrono::system_clock::now() + std::chrono::seconds(30);
-                    needsWaiting = false;
-                    for(int j = 0; j < actions.size(); ++j)
-                    {
-                        if(finished.at(j))
-                            continue;
-                        
-                        if(!actions.at(j).valid())
-                        {
-                            ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                            return DS_ERROR_MSG("Failed to construct actions for building "
-                                                "dependencies");
-                        }
-                        
-                        std::future_status actionStatus = actions.at(j).wait_until(deadline);
-                        if(actionStatus == std::future_status::ready)
+                const int i = currentWave.at(waveDepIndex);
+                actions.emplace_back
+                (
+                    jobPool.AddJob<DS::Result<void>>
+                    (
+                        [
+                            i, 
+                            &profile, 
+                            &availableDependencies, 
+                            &dependenciesLocalCopiesPaths,
+                            &dependenciesRevisions,
+                            jobserver
+                        ]() -> DS::Result<void>
                         {
-                            DS::Result<void> actionResult = actions.at(j).get();
-                            if(!actionResult.HasValue())
+                            //Use the artifacts built by other scripts if the dependency is the same
+                            std::string cacheKey;
+                            const bool cacheable = 
+                                GetDependencyCacheKey(  profile,
+                                                        *availableDependencies.at(i),
+                                                        dependenciesRevisions.at(i),
+                                                        cacheKey);
+                            if( cacheable && 
+                                RestoreDependencyArtifacts( cacheKey, 
+                                                            dependenciesLocalCopiesPaths.at(i)))
                             {
-                                ssLOG_OUTPUT_ALL_CACHE_GROUPED();
-                                actionResult.Error().Message += "\nBuild failed for dependencies";
-                                DS_APPEND_TRACE(actionResult.Error());
-                                return actionResult;
+                                ssLOG_INFO("Using cached build artifacts for " << 
+                                            availableDependencies.at(i)->Name);
+                                return {};
                             }
-                            finished.at(j) = true;
-                        }
-                        else
-                        {
-                            ssLOG_WARNING("Manual interrupt might be needed");
-                            ssLOG_WARNING("Waited 30 seconds, dependencies build still going...");
-                            needsWaiting = true;
+                            
+                            ssLOG_INFO("Running build commands for " << 
+                                        availableDependencies.at(i)->Name);
+                            DS::Result<void> depResult = 
+                                RunDependenciesSteps(   profile, 
+                                                        availableDependencies.at(i)->Build, 
+                                                        dependenciesLocalCopiesPaths.at(i),
+                                                        true,
+                                                        true,   //TODO: Make this (and others) 
+                                                                //      configurable later
+                                                        jobserver);
+                            if(!depResult.HasValue())
+                            {
+                                depResult.Error().Message +=    "\nFailed to build dependency " + 
+                                                                availableDependencies.at(i)->Name;
+                                DS_APPEND_TRACE(depResult.Error());
+                                return depResult;
+                            }
+                            
+                            ssLOG_INFO("Finished build commands for " << 
+                                        availableDependencies.at(i)->Name);
+                            
+                            if( cacheable && 
+                                !StoreDependencyArtifacts(  profile,
+                                                            *availableDependencies.at(i),
+                                                            dependenciesLocalCopiesPaths.at(i),
+                                                            cacheKey))
+                            {
+                                ssLOG_WARNING(  "Failed to cache build artifacts for " << 
+                                                availableDependencies.at(i)->Name);
+                            }
+                            return {};
                         }
-                    }
-                }
-                while(needsWaiting);
-                
-                actions.clear();
-                finished.clear();
+                    )
+                );
             }
-            #endif ////#if RUNCPP2_USE_PARALLEL_FOR_DEP
+            
+            //Evaluate the build results after all of them in this wave are finished
+            DS::Result<void> buildResult = WaitForDependenciesJobs(actions, "build");
+            ssLOG_OUTPUT_ALL_CACHE_GROUPED();
+            buildResult.DS_TRY();
         }
-
-        ssLOG_OUTPUT_ALL_CACHE_GROUPED();
+        
         return {};
     }
 
+    //NOTE: Appends the binaries of each dependency in order, binaries resolved to the same file as 
+    //      the ones already added are skipped
+    inline void 
+    MergeDependenciesBinaries(  const std::vector<std::vector<std::string>>& 
+                                    dependenciesBinariesPaths,
+                                std::vector<std::string>& inOutBinariesPaths)
+    {
+        std::unordered_set<std::string> resolvedPathsSet;
+        std::error_code e;
+        for(int i = 0; i < inOutBinariesPaths.size(); ++i)
+            resolvedPathsSet.insert(ResolveSymlink(inOutBinariesPaths.at(i), e).string());
+        
+        for(int i = 0; i < dependenciesBinariesPaths.size(); ++i)
+        {
+            for(int j = 0; j < dependenciesBinariesPaths.at(i).size(); ++j)
+            {
+                const std::string& binaryPath = dependenciesBinariesPaths.at(i).at(j);
+                if(resolvedPathsSet.insert(ResolveSymlink(binaryPath, e).string()).second)
+                    inOutBinariesPaths.push_back(binaryPath);
+            }
+        }
+    }
+    
+    //NOTE: Binaries already in outBinariesPaths or resolved to the same file are not added again.
+    //      outDependenciesBinariesPaths has all the binaries found by each dependency if provided, 
+    //      including the ones found by other dependencies as well.
     inline DS::Result<void> 
     GatherDependenciesBinaries( const std::vector<Data::DependencyInfo*>& availableDependencies,
                                 const std::vector<std::string>& dependenciesCopiesPaths,
                                 const Data::Profile& profile,
-                                std::vector<std::string>& outBinariesPaths)
+                                std::vector<std::string>& outBinariesPaths,
+                                std::vector<std::vector<std::string>>* 
+                                    outDependenciesBinariesPaths = nullptr)
     {
         ssLOG_FUNC_DEBUG();
         
+        //Binaries are tracked with their resolved paths
         std::unordered_set<std::string> binariesPathsSet;
         for(int i = 0; i < outBinariesPaths.size(); ++i)
-            binariesPathsSet.insert(outBinariesPaths[i]);
+        {
+            std::error_code symlinkEc;
+            const ghc::filesystem::path resolvedPath = 
+                ResolveSymlink(outBinariesPaths.at(i), symlinkEc);
+            binariesPathsSet.insert(runcpp2::ProcessPath(resolvedPath.string()));
+        }
+        
+        if(outDependenciesBinariesPaths)
+            outDependenciesBinariesPaths->assign(availableDependencies.size(), {});
         
         int minimumDependenciesCopiesCount = 0;
         for(int i = 0; i < availableDependencies.size(); ++i)
@@ -508,10 +614,14 @@ namespace runcpp2
                                 " the amount of dependencies copies paths");
         }
         
+        //Search directories are only listed once, even if they are shared between dependencies
+        std::unordered_map<std::string, SearchDirectoryIndex> searchDirectoriesIndices;
+        
         int nonLinkFilesCount = 0;
         for(int i = 0; i < availableDependencies.size(); ++i)
         {
             ssLOG_INFO("Evaluating dependency " << availableDependencies.at(i)->Name);
+            std::unordered_set<std::string> dependencyPathsSet;
             
             if(runcpp2::HasValueFromPlatformMap(availableDependencies.at(i)->FilesToCopy))
             {
@@ -535,7 +645,10 @@ namespace runcpp2
                             const std::string processedSrcPath = runcpp2::ProcessPath(srcPath);
                             outBinariesPaths.push_back(processedSrcPath);
                             binariesPathsSet.insert(processedSrcPath);
+                            dependencyPathsSet.insert(processedSrcPath);
                             ++nonLinkFilesCount;
+                            if(outDependenciesBinariesPaths)
+                                outDependenciesBinariesPaths->at(i).push_back(processedSrcPath);
                             ssLOG_INFO("Added binary path: " << srcPath.string());
                         }
                         else
@@ -601,85 +714,79 @@ namespace runcpp2
 
                     ssLOG_DEBUG("currentSearchDirectory: " << currentSearchDirectory);
                     ssLOG_DEBUG("currentSearchLibraryName: " << currentSearchLibraryName);
-
-                    std::error_code e;
-                    if( !ghc::filesystem::exists(currentSearchDirectory, e) || 
-                        !ghc::filesystem::is_directory(currentSearchDirectory, e))
-                    {
-                        ssLOG_INFO("Invalid search path: " << currentSearchDirectory);
-                        continue;
-                    }
-
-                    //Iterate each files in the directory we are searching
-                    for(auto it : ghc::filesystem::directory_iterator(currentSearchDirectory, e))
+                    
+                    const SearchDirectoryIndex& searchDirectoryIndex = 
+                        GetSearchDirectoryIndex(currentSearchDirectory, searchDirectoriesIndices);
+                    
+                    //Only go through the files with the extensions we are linking
+                    for(int extIndex = 0; extIndex < extensionsToLink.size(); ++extIndex)
                     {
-                        if(it.is_directory())
+                        auto foundFiles = searchDirectoryIndex.find(extensionsToLink.at(extIndex));
+                        if(foundFiles == searchDirectoryIndex.end())
                             continue;
                         
-                        std::string currentFileName = it.path().filename().string();
-                        std::string currentExtension = runcpp2::GetFileExtensionWithoutVersion(it.path());
-                        
-                        ssLOG_DEBUG("currentFileName: " << currentFileName);
-                        ssLOG_DEBUG("currentExtension: " << currentExtension);
-                        
-                        //TODO: Make it not case sensitive?
-                        bool nameMatched = false;
-                        if(currentFileName.find(currentSearchLibraryName) != std::string::npos)
-                            nameMatched = true;
-                        
-                        for(int excludeIndex = 0; 
-                            excludeIndex < profileLinkProperty->ExcludeLibraryNames.size(); 
-                            ++excludeIndex)
+                        for(int fileIndex = 0; fileIndex < foundFiles->second.size(); ++fileIndex)
                         {
-                            std::string currentExcludeLibraryName = 
-                                profileLinkProperty->ExcludeLibraryNames.at(excludeIndex);
+                            const ghc::filesystem::path& currentFilePath = 
+                                foundFiles->second.at(fileIndex);
+                            std::string currentFileName = currentFilePath.filename().string();
                             
-                            if(currentFileName.find(currentExcludeLibraryName) != std::string::npos)
+                            ssLOG_DEBUG("currentFileName: " << currentFileName);
+                            
+                            //TODO: Make it not case sensitive?
+                            bool nameMatched = false;
+                            if(currentFileName.find(currentSearchLibraryName) != std::string::npos)
+                                nameMatched = true;
+                            
+                            for(int excludeIndex = 0; 
+                                excludeIndex < profileLinkProperty->ExcludeLibraryNames.size(); 
+                                ++excludeIndex)
                             {
-                                nameMatched = false;
-                                break;
+                                std::string currentExcludeLibraryName = 
+                                    profileLinkProperty->ExcludeLibraryNames.at(excludeIndex);
+                                
+                                if(currentFileName.find(currentExcludeLibraryName) != 
+                                   std::string::npos)
+                                {
+                                    nameMatched = false;
+                                    break;
+                                }
                             }
-                        }
-                        
-                        if(!nameMatched)
-                            continue;
-                        
-                        bool extensionMatched = false;
-                        for(int extIndex = 0; extIndex < extensionsToLink.size(); ++extIndex)
-                        {
-                            if(currentExtension == extensionsToLink.at(extIndex))
+                            
+                            if(!nameMatched)
+                                continue;
+                            
+                            //Handle symlink
+                            ghc::filesystem::path resolvedPath = currentFilePath;
                             {
-                                extensionMatched = true;
-                                break;
+                                std::error_code symlink_ec;
+                                resolvedPath = ResolveSymlink(resolvedPath, symlink_ec);
+                                if(symlink_ec)
+                                {
+                                    return DS_ERROR_MSG("Failed to resolve symlink: " + 
+                                                        symlink_ec.message());
+                                }
                             }
-                        }
-                        
-                        if(!extensionMatched)
-                            continue;
-                        
-                        //Handle symlink
-                        ghc::filesystem::path resolvedPath = it.path();
-                        {
-                            std::error_code symlink_ec;
-                            resolvedPath = ResolveSymlink(resolvedPath, symlink_ec);
-                            if(symlink_ec)
+                            
+                            const std::string processedPath = 
+                                runcpp2::ProcessPath(currentFilePath.string());
+                            const std::string processedResolvedPath = 
+                                runcpp2::ProcessPath(resolvedPath.string());
+                            
+                            if( outDependenciesBinariesPaths && 
+                                dependencyPathsSet.insert(processedResolvedPath).second)
                             {
-                                return DS_ERROR_MSG("Failed to resolve symlink: " + 
-                                                    symlink_ec.message());
+                                outDependenciesBinariesPaths->at(i).push_back(processedPath);
+                            }
+                            
+                            if(binariesPathsSet.count(processedResolvedPath) == 0)
+                            {
+                                ssLOG_INFO("Linking " << processedPath);
+                                outBinariesPaths.push_back(processedPath);
+                                binariesPathsSet.insert(processedResolvedPath);
                             }
                         }
-                        
-                        const std::string processedPath = runcpp2::ProcessPath(it.path().string());
-                        const std::string processedResolvedPath = 
-                            runcpp2::ProcessPath(resolvedPath.string());
-                        
-                        if(binariesPathsSet.count(processedResolvedPath) == 0)
-                        {
-                            ssLOG_INFO("Linking " << processedPath);
-                            outBinariesPaths.push_back(processedPath);
-                            binariesPathsSet.insert(processedResolvedPath);
-                        }
-                    } //for(auto it : ghc::filesystem::directory_iterator(currentSearchDirectory, e))
+                    }
                 
                 }   //for(int searchDirIndex = 0; 
                     //searchDirIndex < profileLinkProperty->SearchDirectories.size(); 
@@ -820,8 +927,14 @@ namespace runcpp2
             ghc::filesystem::path sourcePath;
             GetDependencyPath(dependency, scriptDirectory, buildDir, copyPath, sourcePath).DS_TRY();
 
+            //NOTE: The revisions are only locked for the resolved dependencies
             bool prePopulated = false;
-            PopulateLocalDependency(dependency, copyPath, sourcePath, buildDir, prePopulated).DS_TRY();
+            PopulateLocalDependency(dependency, 
+                                    copyPath, 
+                                    sourcePath, 
+                                    buildDir, 
+                                    "", 
+                                    prePopulated).DS_TRY();
             
             //Parse the import file
             HandleImport(dependency, scriptInfo.SubstitutionMap, copyPath, inputParameters).DS_TRY();
@@ -834,18 +947,28 @@ namespace runcpp2
         return {};
     }
 
+    //NOTE: outRevision is set to the revision of the synced files if provided, which is the hash 
+    //      of the sizes and write times of all the files in the sync manifest
     inline DS::Result<void> SyncLocalDependency(const Data::DependencyInfo& dependency,
                                                 const ghc::filesystem::path& sourcePath,
-                                                const ghc::filesystem::path& copyPath)
+                                                const ghc::filesystem::path& copyPath,
+                                                std::string* outRevision = nullptr)
     {
         ssLOG_FUNC_INFO();
         INTERNAL_RUNCPP2_SAFE_START()
         
         std::error_code ec;
 
-        //Only sync if it's a local dependency
+        //Only sync if it's a local dependency or extracted archive
+        Data::LocalCopyMode copyMode;
         const Data::LocalSource* local = mpark::get_if<Data::LocalSource>(&dependency.Source.Source);
-        if(!local)
+        const Data::ArchiveSource* archive = 
+            mpark::get_if<Data::ArchiveSource>(&dependency.Source.Source);
+        if(local)
+            copyMode = local->CopyMode;
+        else if(archive)
+            copyMode = archive->CopyMode;
+        else
         {
             ssLOG_DEBUG("Not a local dependency, skipping sync");
             return {};
@@ -861,27 +984,40 @@ namespace runcpp2
             if(!ghc::filesystem::create_directory(copyPath, ec))
                 return DS_ERROR_MSG("Failed to create directory " + copyPath.string() + ": " + ec.message());
         }
-
-        //Get list of files in source
-        std::unordered_set<std::string> sourceFiles;
-        for(const ghc::filesystem::directory_entry& entry : 
-            ghc::filesystem::directory_iterator(sourcePath, ec))
+        
+        //Nothing to sync if the dependency is used in place, only the files are recorded
+        if(ghc::filesystem::equivalent(sourcePath, copyPath, ec))
         {
-            sourceFiles.insert(entry.path().filename().string());
+            if(outRevision != nullptr)
+            {
+                std::unordered_map<std::string, std::string> manifest;
+                for(const ghc::filesystem::directory_entry& entry : 
+                    ghc::filesystem::directory_iterator(sourcePath, ec))
+                {
+                    AddToSyncManifest(entry.path(), sourcePath, manifest).DS_TRY();
+                }
+                *outRevision = GetSyncManifestRevision(manifest);
+            }
+            return {};
         }
 
-        ghc::filesystem::copy_options copyOptions = ghc::filesystem::copy_options::overwrite_existing |
-                                                    ghc::filesystem::copy_options::recursive |
-                                                    ghc::filesystem::copy_options::copy_symlinks;
+        //NOTE: The manifest records the size and write time of each file synced last time, so 
+        //      that only the changed files are synced instead of whole directories
+        const ghc::filesystem::path manifestPath = copyPath / ".runcpp2SyncManifest";
+        std::unordered_map<std::string, std::string> lastManifest;
+        std::unordered_map<std::string, std::string> newManifest;
+        ReadSyncManifest(manifestPath, lastManifest);
         
-        //First pass: Check existing files in target
+        //First pass: Remove files in target that no longer exist in source or are invalid
         for(const ghc::filesystem::directory_entry& entry : 
             ghc::filesystem::directory_iterator(copyPath, ec))
         {
             const ghc::filesystem::path& targetPath = entry.path();
             const ghc::filesystem::path& srcPath = sourcePath / targetPath.filename();
-            bool needsUpdate = false;
-
+            
+            if(targetPath.filename() == manifestPath.filename())
+                continue;
+            
             //Check if this is a symlink
             if(ghc::filesystem::is_symlink(targetPath, ec))
             {
@@ -890,10 +1026,10 @@ namespace runcpp2
                 {
                     ssLOG_DEBUG("Found invalid symlink, removing: " << targetPath.string());
                     ghc::filesystem::remove_all(targetPath, ec);
-                    needsUpdate = true;
+                    continue;
                 }
             }
-
+            
             if(!ghc::filesystem::exists(srcPath, ec))
             {
                 //File no longer exists in source, remove it
@@ -901,156 +1037,548 @@ namespace runcpp2
                 ghc::filesystem::remove_all(targetPath, ec);
                 continue;
             }
+        }
+        
+        //Second pass: Add or update files from source
+        for(const ghc::filesystem::directory_entry& entry : 
+            ghc::filesystem::directory_iterator(sourcePath, ec))
+        {
+            const ghc::filesystem::path& srcPath = entry.path();
+            const ghc::filesystem::path& targetPath = copyPath / srcPath.filename();
+            
+            //Symlinks always reflect the source, nothing to update other than the manifest
+            if(ghc::filesystem::is_symlink(targetPath, ec))
+            {
+                AddToSyncManifest(srcPath, sourcePath, newManifest).DS_TRY();
+                continue;
+            }
             
-            //If file/dir exists in source and not symlink, check if it needs update
-            if(!needsUpdate && !ghc::filesystem::is_symlink(targetPath, ec))
+            if(!entry.is_directory(ec) || entry.is_symlink(ec))
             {
-                ghc::filesystem::file_time_type srcTime = ghc::filesystem::last_write_time( srcPath, 
-                                                                                            ec);
-                ghc::filesystem::file_time_type dstTime = 
-                    ghc::filesystem::last_write_time(targetPath, ec);
-                
-                if(ec)
-                    return DS_ERROR_MSG(ec.message());
-                
-                //NOTE: If it is a directory, we can't trust the last write time as it doesn't 
-                //      reflect the last write time of the files in it, for source. 
-                //      It's probably fine for destination because we are copying/deleting the 
-                //      directory every time.
-                if(ghc::filesystem::is_directory(srcPath, ec))
+                SyncLocalFile(  copyMode, 
+                                srcPath, 
+                                targetPath, 
+                                srcPath.filename().generic_string(),
+                                lastManifest, 
+                                newManifest).DS_TRY();
+                continue;
+            }
+            
+            //Link the directory if possible, otherwise sync the files inside it
+            if( ghc::filesystem::exists(targetPath, ec) && 
+                !ghc::filesystem::is_directory(targetPath, ec))
+            {
+                ghc::filesystem::remove_all(targetPath, ec);
+            }
+            
+            if(!ghc::filesystem::exists(targetPath, ec))
+            {
+                if( copyMode == Data::LocalCopyMode::Auto || 
+                    copyMode == Data::LocalCopyMode::Symlink)
                 {
-                    using DirIt = ghc::filesystem::recursive_directory_iterator;
-                    for(const ghc::filesystem::directory_entry& checkEntry : DirIt(srcPath))
+                    ssLOG_DEBUG("Adding new directory: " << targetPath.string());
+                    ghc::filesystem::create_symlink(srcPath, targetPath, ec);
+                    if(!ec)
                     {
-                        ghc::filesystem::file_time_type checkTime =
-                            ghc::filesystem::last_write_time(checkEntry.path(), ec);
-                        srcTime = checkTime > srcTime ? checkTime : srcTime;
-                        if(ec)
-                            return DS_ERROR_MSG(checkEntry.path().string() + "Failed: " + ec.message());
+                        AddToSyncManifest(srcPath, sourcePath, newManifest).DS_TRY();
+                        continue;
                     }
+                    
+                    if(copyMode == Data::LocalCopyMode::Symlink)
+                        return DS_ERROR_MSG("Failed to add new file: " + ec.message());
+                    
+                    ssLOG_DEBUG("Symlink failed: " << ec.message());
+                    ec.clear();
                 }
-                else if(!ghc::filesystem::is_regular_file(srcPath, ec))
+                
+                if(!ghc::filesystem::create_directory(targetPath, ec))
                 {
-                    //TODO: What do we do?...
+                    return DS_ERROR_MSG("Failed to create directory " + targetPath.string() + 
+                                        ": " + ec.message());
                 }
-                
-                needsUpdate = (srcTime > dstTime);
             }
-
-            if(needsUpdate)
+            
+            newManifest[srcPath.filename().generic_string()] = "Directory|0";
+            using DirIt = ghc::filesystem::recursive_directory_iterator;
+            for(DirIt it(srcPath, ec); !ec && it != DirIt(); it.increment(ec))
             {
-                ssLOG_DEBUG("Updating: " << targetPath.string());
-                ghc::filesystem::remove_all(targetPath, ec);
-                if(ec)
-                    return DS_ERROR_MSG(ec.message());
+                const std::string relativePath = 
+                    it->path().lexically_relative(sourcePath).generic_string();
+                const ghc::filesystem::path currentTargetPath = copyPath / relativePath;
                 
-                switch(local->CopyMode)
+                if(it->is_directory(ec) && !it->is_symlink(ec))
                 {
-                    case Data::LocalCopyMode::Auto:
-                        ghc::filesystem::create_symlink(srcPath, targetPath, ec);
+                    if(!ghc::filesystem::is_directory(currentTargetPath, ec))
+                    {
+                        ghc::filesystem::remove_all(currentTargetPath, ec);
+                        ghc::filesystem::create_directory(currentTargetPath, ec);
                         if(ec)
                         {
-                            ssLOG_DEBUG("Symlink failed: " << ec.message());
-                            ec.clear();
-                            ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
-                            if(ec)
-                            {
-                                ssLOG_DEBUG("Hardlink failed: " << ec.message());
-                                ec.clear();
-                                ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
-                            }
+                            return DS_ERROR_MSG("Failed to create directory " + 
+                                                currentTargetPath.string() + ": " + ec.message());
                         }
-                        break;
-
-                    case Data::LocalCopyMode::Symlink:
-                        ghc::filesystem::create_symlink(srcPath, targetPath, ec);
-                        break;
-
-                    case Data::LocalCopyMode::Hardlink:
-                        ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
-                        break;
-
-                    case Data::LocalCopyMode::Copy:
-                        ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
-                        break;
+                    }
+                    newManifest[relativePath] = "Directory|0";
+                    continue;
                 }
-
-                if(ec)
-                    return DS_ERROR_MSG("Failed to update target: " + ec.message());
+                
+                SyncLocalFile(  copyMode, 
+                                it->path(), 
+                                currentTargetPath, 
+                                relativePath,
+                                lastManifest, 
+                                newManifest).DS_TRY();
             }
-            sourceFiles.erase(targetPath.filename().string());
+            
+            if(ec)
+                return DS_ERROR_MSG(srcPath.string() + " Failed: " + ec.message());
         }
-
-        //Second pass: Add any new files from source
-        for(const std::string& filename : sourceFiles)
+        
+        //Remove the files synced last time that no longer exist in source
+        for(auto it = lastManifest.begin(); it != lastManifest.end(); ++it)
         {
-            const ghc::filesystem::path& srcPath = sourcePath / filename;
-            const ghc::filesystem::path& targetPath = copyPath / filename;
+            if(newManifest.count(it->first) > 0)
+                continue;
             
-            ssLOG_DEBUG("Adding new file: " << targetPath.string());
+            //Don't remove anything through symlinks, which would remove the source files instead
+            const ghc::filesystem::path relativePath = it->first;
+            if(ghc::filesystem::is_symlink(copyPath / *relativePath.begin(), ec))
+                continue;
             
-            switch(local->CopyMode)
+            const ghc::filesystem::path targetPath = copyPath / relativePath;
+            if(ghc::filesystem::exists(ghc::filesystem::symlink_status(targetPath, ec)))
             {
-                case Data::LocalCopyMode::Auto:
-                    ghc::filesystem::create_symlink(srcPath, targetPath, ec);
-                    if(ec)
-                    {
-                        ssLOG_DEBUG("Symlink failed: " << ec.message());
-                        ec.clear();
-                        ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
-                        if(ec)
-                        {
-                            ssLOG_DEBUG("Hardlink failed: " << ec.message());
-                            ec.clear();
-                            ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
-                        }
-                    }
-                    break;
-
-                case Data::LocalCopyMode::Symlink:
-                    ghc::filesystem::create_symlink(srcPath, targetPath, ec);
-                    break;
-
-                case Data::LocalCopyMode::Hardlink:
-                    ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
-                    break;
-
-                case Data::LocalCopyMode::Copy:
-                    ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
-                    break;
+                ssLOG_DEBUG("Removing file that no longer exists in source: " << targetPath.string());
+                ghc::filesystem::remove_all(targetPath, ec);
             }
-
-            if(ec)
-                return DS_ERROR_MSG("Failed to add new file: " + ec.message());
         }
-
+        
+        if(newManifest != lastManifest && !WriteSyncManifest(manifestPath, newManifest))
+            ssLOG_WARNING("Failed to write sync manifest: " << manifestPath.string());
+        
+        if(outRevision != nullptr)
+            *outRevision = GetSyncManifestRevision(newManifest);
+        
         return {};
         
         INTERNAL_RUNCPP2_SAFE_CATCH_RETURN( DS_ERROR_MSG(DS_STR("Exception caught: ") + ex.what()) )
     }
 
+    //NOTE: Only the local dependencies without revisions are synced, which are the ones not 
+    //      synced yet. Their revisions are set after syncing.
     inline DS::Result<void> 
     SyncLocalDependencies(  const std::vector<Data::DependencyInfo*>& dependencies,
                             const std::vector<std::string>& dependenciesSourcePaths,
-                            const std::vector<std::string>& dependenciesCopiesPaths)
+                            const std::vector<std::string>& dependenciesCopiesPaths,
+                            std::vector<std::string>& inOutLocalRevisions)
     {
         ssLOG_FUNC_DEBUG();
         for(size_t i = 0; i < dependencies.size(); ++i)
         {
+            if(!inOutLocalRevisions.at(i).empty())
+                continue;
+            
             SyncLocalDependency(*dependencies.at(i),
                                 ghc::filesystem::path(dependenciesSourcePaths.at(i)),
-                                ghc::filesystem::path(dependenciesCopiesPaths.at(i))).DS_TRY();
+                                ghc::filesystem::path(dependenciesCopiesPaths.at(i)),
+                                &inOutLocalRevisions.at(i)).DS_TRY();
         }
 
         return {};
     }
-}
-
-namespace
-{
-    DS::Result<void> GetDependencyPath( const runcpp2::Data::DependencyInfo& dependency,
-                                        const ghc::filesystem::path& scriptDirectory,
-                                        const ghc::filesystem::path& buildDir,
+    
+    inline ghc::filesystem::path 
+    GetDependenciesLockPath(const ghc::filesystem::path& scriptDirectory, 
+                            const std::string& scriptName)
+    {
+        return scriptDirectory / (scriptName + ".runcpp2.lock");
+    }
+    
+    //NOTE: The lock is left empty if the lockfile doesn't exist
+    inline DS::Result<void> ReadDependenciesLock(   const ghc::filesystem::path& lockFilePath,
+                                                    Data::DependenciesLock& outLock)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        outLock = Data::DependenciesLock();
+        
+        std::error_code e;
+        if(!ghc::filesystem::exists(lockFilePath, e))
+            return {};
+        
+        std::string content;
+        {
+            std::ifstream file(lockFilePath.string());
+            if(!file.is_open())
+                return DS_ERROR_MSG("Failed to open lockfile: " + lockFilePath.string());
+            
+            std::stringstream buffer;
+            buffer << file.rdbuf();
+            content = buffer.str();
+        }
+        
+        YAML::ResourceHandle resource;
+        std::vector<YAML::NodePtr> rootNodes = YAML::ParseYAML(content, resource).DS_TRY();
+        DEFER { YAML::FreeYAMLResource(resource); };
+        
+        if(rootNodes.empty())
+            return {};
+        
+        if(!outLock.ParseYAML_Node(rootNodes.front()))
+            return DS_ERROR_MSG("Failed to parse lockfile: " + lockFilePath.string());
+        
+        return {};
+    }
+    
+    inline DS::Result<void> WriteDependenciesLock(  const ghc::filesystem::path& lockFilePath,
+                                                    const Data::DependenciesLock& lock)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        //Write to a temporary file first so that the lockfile is never partially written
+        const ghc::filesystem::path tempLockPath = GetTemporaryPath(lockFilePath);
+        std::error_code e;
+        {
+            std::ofstream file(tempLockPath.string(), std::ios::binary);
+            if(!file.is_open())
+                return DS_ERROR_MSG("Failed to write lockfile: " + tempLockPath.string());
+            
+            file << "#Generated by runcpp2, use `runcpp2 lock` to update the revisions\n";
+            file << lock.ToString("");
+            if(!file)
+            {
+                file.close();
+                ghc::filesystem::remove(tempLockPath, e);
+                return DS_ERROR_MSG("Failed to write lockfile: " + tempLockPath.string());
+            }
+        }
+        
+        ghc::filesystem::rename(tempLockPath, lockFilePath, e);
+        if(e)
+        {
+            const std::string errorMessage = e.message();
+            ghc::filesystem::remove(tempLockPath, e);
+            return DS_ERROR_MSG("Failed to write lockfile: " + lockFilePath.string() + 
+                                ": " + errorMessage);
+        }
+        
+        return {};
+    }
+    
+    //NOTE: Gets the names of the populated git dependencies that are not at the locked revisions,
+    //      which need to be populated again
+    inline void 
+    GetDependenciesNotAtLockedRevisions(const std::vector<Data::DependencyInfo*>& dependencies,
+                                        const std::vector<std::string>& dependenciesCopiesPaths,
+                                        const Data::DependenciesLock& lock,
+                                        std::vector<std::string>& outDependenciesNames)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        for(int i = 0; i < dependencies.size(); ++i)
+        {
+            const Data::DependencyInfo& dependency = *dependencies.at(i);
+            if(!mpark::get_if<Data::GitSource>(&(dependency.Source.Source)))
+                continue;
+            
+            const std::string* lockedRevision = GetLockedRevision(lock, dependency);
+            std::error_code e;
+            if( lockedRevision == nullptr || 
+                !ghc::filesystem::is_directory(dependenciesCopiesPaths.at(i), e))
+            {
+                continue;
+            }
+            
+            std::string revision;
+            if(!GetDependencyRevision(dependency, dependenciesCopiesPaths.at(i), revision) ||
+                revision != *lockedRevision)
+            {
+                ssLOG_INFO( dependency.Name << " is not at the locked revision " << 
+                            *lockedRevision);
+                outDependenciesNames.push_back(dependency.Name);
+            }
+        }
+    }
+    
+    //NOTE: Gets the current revisions of the populated dependencies and writes the ones of git and 
+    //      archive dependencies to the lockfile if they have changed. Local dependencies are not 
+    //      locked, their revisions are only recorded in the build directory. The revisions of the 
+    //      dependencies for other platforms are kept. Revisions that failed to be read are empty.
+    //      Failing to write the lockfile is only a warning.
+    //      The revisions of the local dependencies are from syncing them and are passed in 
+    //      inOutRevisions, the rest are read.
+    inline DS::Result<void> 
+    UpdateDependenciesLock( const Data::ScriptInfo& scriptInfo,
+                            const std::vector<Data::DependencyInfo*>& availableDependencies,
+                            const std::vector<std::string>& dependenciesCopiesPaths,
+                            const ghc::filesystem::path& lockFilePath,
+                            const Data::DependenciesLock& lastLock,
+                            std::vector<std::string>& inOutRevisions)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        Data::DependenciesLock lock;
+        GetScriptDependenciesLock(scriptInfo, lastLock, lock);
+        
+        inOutRevisions.resize(availableDependencies.size());
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            const bool isLocal = 
+                mpark::get_if<Data::LocalSource>(&(availableDependencies.at(i)->Source.Source));
+            if( isLocal ? 
+                inOutRevisions.at(i).empty() :
+                !GetDependencyRevision( *availableDependencies.at(i),
+                                        dependenciesCopiesPaths.at(i),
+                                        inOutRevisions.at(i)))
+            {
+                ssLOG_WARNING(  "Failed to get the revision of " << 
+                                availableDependencies.at(i)->Name);
+                inOutRevisions.at(i).clear();
+                continue;
+            }
+            
+            Data::LockedRevision lockedRevision;
+            if(!GetDependencyLockSource(*availableDependencies.at(i), lockedRevision.Source))
+            {
+                lock.Revisions.erase(availableDependencies.at(i)->Name);
+                continue;
+            }
+            
+            lockedRevision.Revision = inOutRevisions.at(i);
+            lock.Revisions[availableDependencies.at(i)->Name] = lockedRevision;
+        }
+        
+        if(!lock.Equals(lastLock))
+        {
+            //NOTE: The script can be in a read-only directory, the revisions are still used for 
+            //      this run even if they can't be locked
+            ssLOG_INFO("Updating lockfile " << lockFilePath.string());
+            DS::Result<void> writeResult = WriteDependenciesLock(lockFilePath, lock);
+            if(!writeResult.HasValue())
+            {
+                ssLOG_WARNING(  "Failed to update lockfile " << lockFilePath.string() << ": " << 
+                                writeResult.Error().Message);
+            }
+        }
+        
+        return {};
+    }
+    
+    //NOTE: Resolves the latest revisions of the dependencies and writes them to the lockfile.
+    //      Git dependencies are resolved with the remote repositories, and the populated copies 
+    //      are checked out at the new revisions the next time they are used.
+    inline DS::Result<void> 
+    RefreshDependenciesLock(const Data::ScriptInfo& scriptInfo,
+                            const std::vector<Data::DependencyInfo*>& availableDependencies,
+                            const std::vector<std::string>& dependenciesCopiesPaths,
+                            const ghc::filesystem::path& lockFilePath)
+    {
+        ssLOG_FUNC_INFO();
+        
+        Data::DependenciesLock lastLock;
+        ReadDependenciesLock(lockFilePath, lastLock).DS_TRY();
+        
+        Data::DependenciesLock lock;
+        GetScriptDependenciesLock(scriptInfo, lastLock, lock);
+        
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            const Data::DependencyInfo& dependency = *availableDependencies.at(i);
+            const Data::GitSource* git = 
+                mpark::get_if<Data::GitSource>(&(dependency.Source.Source));
+            
+            Data::LockedRevision lockedRevision;
+            if(!GetDependencyLockSource(dependency, lockedRevision.Source))
+            {
+                lock.Revisions.erase(dependency.Name);
+                continue;
+            }
+            
+            std::string revision;
+            if(git ? 
+                !GetRemoteGitRevision(*git, revision) :
+                !GetDependencyRevision(dependency, dependenciesCopiesPaths.at(i), revision))
+            {
+                return DS_ERROR_MSG("Failed to resolve the revision of " + dependency.Name);
+            }
+            
+            ssLOG_INFO(dependency.Name << " is locked at " << revision);
+            lockedRevision.Revision = revision;
+            lock.Revisions[dependency.Name] = lockedRevision;
+        }
+        
+        WriteDependenciesLock(lockFilePath, lock).DS_TRY();
+        return {};
+    }
+    
+    //NOTE: A dependency is ready if it is populated, setup and built at the locked revision with 
+    //      the same profile and settings as the last time, in which case it doesn't need to be 
+    //      processed again and the binaries it gathered last time are used. Local dependencies 
+    //      are checked with localRevisions instead since they are not locked, which are from 
+    //      syncing them and are empty if they are not synced.
+    //      outRecords have the keys of all the dependencies, and the revisions and binaries of 
+    //      the ready ones. The include paths of the ready dependencies are populated.
+    inline DS::Result<void> 
+    GetReadyDependencies(   const Data::Profile& profile,
+                            const ghc::filesystem::path& buildDir,
+                            const std::vector<Data::DependencyInfo*>& availableDependencies,
+                            const std::vector<std::string>& dependenciesCopiesPaths,
+                            const std::vector<std::string>& localRevisions,
+                            const Data::DependenciesLock& lock,
+                            const std::vector<std::string>& changedDependencies,
+                            std::vector<bool>& outReady,
+                            std::vector<Data::DependencyReadyRecord>& outRecords)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        outReady.assign(availableDependencies.size(), false);
+        outRecords.assign(availableDependencies.size(), Data::DependencyReadyRecord());
+        
+        std::map<std::string, Data::DependencyReadyRecord> lastRecords;
+        ReadDependenciesReadyRecords(buildDir, lastRecords);
+        
+        std::unordered_map<std::string, int> nameIndices;
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            const Data::DependencyInfo& dependency = *availableDependencies.at(i);
+            nameIndices[dependency.Name] = i;
+            outRecords.at(i).Key = GetDependencyReadyKey(profile, dependency);
+            
+            if( std::find(  changedDependencies.begin(), 
+                            changedDependencies.end(), 
+                            dependency.Name) != changedDependencies.end())
+            {
+                continue;
+            }
+            
+            std::map<std::string, Data::DependencyReadyRecord>::const_iterator recordIt = 
+                lastRecords.find(dependency.Name);
+            if(recordIt == lastRecords.end() || recordIt->second.Key != outRecords.at(i).Key)
+                continue;
+            
+            std::string currentRevision;
+            if(mpark::get_if<Data::LocalSource>(&(dependency.Source.Source)))
+            {
+                if(localRevisions.at(i).empty())
+                    continue;
+                
+                currentRevision = localRevisions.at(i);
+            }
+            else
+            {
+                const std::string* lockedRevision = GetLockedRevision(lock, dependency);
+                if(lockedRevision == nullptr)
+                    continue;
+                
+                currentRevision = *lockedRevision;
+            }
+            
+            if(recordIt->second.Revision != currentRevision)
+                continue;
+            
+            std::error_code e;
+            bool filesExist = ghc::filesystem::is_directory(dependenciesCopiesPaths.at(i), e);
+            if( filesExist && 
+                mpark::get_if<Data::GitSource>(&(dependency.Source.Source)) &&
+                !IsGitCopyValid(dependenciesCopiesPaths.at(i), false))
+            {
+                filesExist = false;
+            }
+            for(int j = 0; filesExist && j < recordIt->second.BinariesPaths.size(); ++j)
+                filesExist = ghc::filesystem::exists(recordIt->second.BinariesPaths.at(j), e);
+            
+            if(!filesExist)
+                continue;
+            
+            outReady.at(i) = true;
+            outRecords.at(i) = recordIt->second;
+        }
+        
+        //Dependencies that depend on the ones being processed need to be processed as well
+        for(bool readyChanged = true; readyChanged;)
+        {
+            readyChanged = false;
+            for(int i = 0; i < availableDependencies.size(); ++i)
+            {
+                const std::vector<std::string>& dependsOn = availableDependencies.at(i)->DependsOn;
+                for(int j = 0; outReady.at(i) && j < dependsOn.size(); ++j)
+                {
+                    std::unordered_map<std::string, int>::const_iterator foundIt = 
+                        nameIndices.find(dependsOn.at(j));
+                    if(foundIt != nameIndices.end() && !outReady.at(foundIt->second))
+                    {
+                        outReady.at(i) = false;
+                        readyChanged = true;
+                    }
+                }
+            }
+        }
+        
+        std::vector<Data::DependencyInfo*> readyDependencies;
+        std::vector<std::string> readyCopiesPaths;
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            if(!outReady.at(i))
+                continue;
+            
+            ssLOG_INFO(availableDependencies.at(i)->Name << " is unchanged, skip processing it");
+            readyDependencies.push_back(availableDependencies.at(i));
+            readyCopiesPaths.push_back(dependenciesCopiesPaths.at(i));
+        }
+        
+        PopulateAbsoluteIncludePaths(readyDependencies, readyCopiesPaths).DS_TRY();
+        return {};
+    }
+    
+    //NOTE: Writes the records of the dependencies if they have changed. Records of the 
+    //      dependencies that are not available anymore are removed.
+    inline DS::Result<void> 
+    WriteDependenciesReadyRecords(  const ghc::filesystem::path& buildDir,
+                                    const std::vector<Data::DependencyInfo*>& availableDependencies,
+                                    const std::vector<Data::DependencyReadyRecord>& records)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        std::map<std::string, Data::DependencyReadyRecord> lastRecords;
+        ReadDependenciesReadyRecords(buildDir, lastRecords);
+        
+        bool recordsChanged = lastRecords.size() != availableDependencies.size();
+        std::string recordsString;
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            std::map<std::string, Data::DependencyReadyRecord>::const_iterator lastRecordIt = 
+                lastRecords.find(availableDependencies.at(i)->Name);
+            if( lastRecordIt == lastRecords.end() || 
+                !lastRecordIt->second.Equals(records.at(i)))
+            {
+                recordsChanged = true;
+            }
+            
+            recordsString +=    GetEscapedYAMLString(availableDependencies.at(i)->Name) + ":\n" + 
+                                records.at(i).ToString("    ");
+        }
+        
+        if(!recordsChanged)
+            return {};
+        
+        const ghc::filesystem::path recordsPath = buildDir / "DependenciesReady.yaml";
+        std::ofstream recordsFile(recordsPath.string(), std::ios::binary);
+        if(!recordsFile.is_open())
+            return DS_ERROR_MSG("Failed to write dependencies records: " + recordsPath.string());
+        
+        recordsFile << (recordsString.empty() ? "{}\n" : recordsString);
+        if(!recordsFile)
+            return DS_ERROR_MSG("Failed to write dependencies records: " + recordsPath.string());
+        
+        return {};
+    }
+}
+
+namespace
+{
+    DS::Result<void> GetDependencyPath( const runcpp2::Data::DependencyInfo& dependency,
+                                        const ghc::filesystem::path& scriptDirectory,
+                                        const ghc::filesystem::path& buildDir,
                                         ghc::filesystem::path& outCopyPath,
                                         ghc::filesystem::path& outSourcePath)
     {
@@ -1117,54 +1645,538 @@ namespace
             else
                 outCopyPath = outSourcePath;
         }
+        else if(mpark::get_if<runcpp2::Data::ArchiveSource>(&currentSource.Source))
+        {
+            const runcpp2::Data::ArchiveSource* archive = 
+                mpark::get_if<runcpp2::Data::ArchiveSource>(&currentSource.Source);
+            
+            std::string archivePathString = archive->Path;
+            if(archivePathString.find("file://") == 0)
+            {
+                archivePathString = archivePathString.substr(std::string("file://").size());
+                
+                //file:///C:/... on Windows
+                if( archivePathString.size() > 2 && 
+                    archivePathString.at(0) == '/' && 
+                    archivePathString.at(2) == ':')
+                {
+                    archivePathString.erase(0, 1);
+                }
+            }
+            else if(archivePathString.find("://") != std::string::npos)
+                return DS_ERROR_MSG("Only local archives are supported: " + archive->Path);
+            
+            ghc::filesystem::path archivePath = archivePathString;
+            if(archivePath.is_relative())
+                archivePath = scriptDirectory / archivePath;
+            
+            //NOTE: The archive is extracted once to the store shared by all the scripts, keyed by 
+            //      its hash. This is done here instead of populating since the archive path can 
+            //      be relative to the script directory.
+            ghc::filesystem::path archivesDir;
+            if(!GetUserCacheDirectory("Archives", archivesDir))
+                return DS_ERROR_MSG("Failed to get the archives directory");
+            
+            outSourcePath = archivesDir / archive->SHA256;
+            ExtractArchiveIfNeeded(*archive, archivePath, outSourcePath).DS_TRY();
+            
+            if(currentSource.ImportPath.empty())
+                outCopyPath = (buildDir / GetArchiveName(archivePath));
+            else
+                outCopyPath = outSourcePath;
+        }
         
         return {};
     }
     
-    DS::Result<void> PopulateLocalDependency(   const runcpp2::Data::DependencyInfo& dependency,
-                                                const ghc::filesystem::path& copyPath,
-                                                const ghc::filesystem::path& sourcePath,
-                                                const ghc::filesystem::path& buildDir,
-                                                bool& outPrePopulated)
+    //NOTE: Gets the archive file name without the archive extensions
+    std::string GetArchiveName(const ghc::filesystem::path& archivePath)
     {
-        ssLOG_FUNC_INFO();
-        
-        std::error_code e;
+        const std::string archiveExtensions[] = 
+        {
+            ".tar.gz", ".tar.bz2", ".tar.xz", ".tgz", ".tbz2", ".txz", ".tar", ".zip"
+        };
         
-        if(ghc::filesystem::exists(copyPath, e))
+        const std::string fileName = archivePath.filename().string();
+        for(int i = 0; i < sizeof(archiveExtensions) / sizeof(std::string); ++i)
         {
-            if(!ghc::filesystem::is_directory(copyPath, e))
+            const std::string& extension = archiveExtensions[i];
+            if( fileName.size() > extension.size() && 
+                fileName.compare(   fileName.size() - extension.size(), 
+                                    extension.size(), 
+                                    extension) == 0)
             {
-                return DS_ERROR_MSG("Dependency path is a file: " + copyPath.string() + "\n" +
-                                    "It should be a folder instead");
+                return fileName.substr(0, fileName.size() - extension.size());
             }
-            outPrePopulated = true;
+        }
+        
+        return archivePath.stem().string();
+    }
+    
+    DS::Result<void> ExtractArchiveIfNeeded(const runcpp2::Data::ArchiveSource& archive,
+                                            const ghc::filesystem::path& archivePath,
+                                            const ghc::filesystem::path& extractedPath)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        std::error_code e;
+        if(ghc::filesystem::is_directory(extractedPath, e))
             return {};
+        
+        if(!ghc::filesystem::is_regular_file(archivePath, e))
+            return DS_ERROR_MSG("Archive not found: " + archivePath.string());
+        
+        std::string archiveHash;
+        if(!runcpp2::GetFileSha256(archivePath, archiveHash))
+            return DS_ERROR_MSG("Failed to read archive: " + archivePath.string());
+        
+        if(archiveHash != archive.SHA256)
+        {
+            return DS_ERROR_MSG("SHA256 mismatch for " + archivePath.string() + "\n" +
+                                "Expected: " + archive.SHA256 + "\n" +
+                                "Actual: " + archiveHash);
         }
-        else
+        
+        //NOTE: Extract to a temporary directory first, so that other runcpp2 processes never see
+        //      a partially extracted archive
+        const ghc::filesystem::path tempPath = GetTemporaryPath(extractedPath);
+        if(!ghc::filesystem::create_directories(tempPath, e))
+            return DS_ERROR_MSG("Failed to create directory: " + tempPath.string());
+        
+        DEFER { ghc::filesystem::remove_all(tempPath, e); };
+        
+        const std::string archiveExtension = 
+            archivePath.filename().string().substr(GetArchiveName(archivePath).size());
+        std::string extractCommand;
+        #if defined(_WIN32)
+            //tar on Windows can extract zip files as well
+            extractCommand = "tar -xf \"" + archivePath.string() + "\"";
+        #else
+            if(archiveExtension == ".zip")
+                extractCommand = "unzip -q \"" + archivePath.string() + "\"";
+            else
+                extractCommand = "tar -xf \"" + archivePath.string() + "\"";
+        #endif
+        
+        ssLOG_INFO("Extracting " << archivePath.string() << " to " << extractedPath.string());
+        int returnCode = 0;
+        std::string output;
+        if(!runcpp2::RunCommand(extractCommand, true, tempPath.string(), output, returnCode))
+        {
+            return DS_ERROR_MSG("Failed to extract archive with result: " + DS_STR(returnCode) + 
+                                "\nWas trying to run: " + extractCommand + 
+                                "\nOutput: \n" + output);
+        }
+        
+        //Use the top level directory as the root if it is the only thing in the archive
+        ghc::filesystem::path rootPath = tempPath;
         {
-            if(mpark::get_if<runcpp2::Data::GitSource>(&(dependency.Source.Source)))
+            int entriesCount = 0;
+            ghc::filesystem::path firstEntry;
+            for(ghc::filesystem::directory_iterator it(tempPath, e); 
+                !e && it != ghc::filesystem::directory_iterator(); 
+                it.increment(e))
             {
-                const runcpp2::Data::GitSource* git = 
-                    mpark::get_if<runcpp2::Data::GitSource>(&(dependency.Source.Source));
-                
-                std::string submoduleString;
-                static_assert(  static_cast<int>(runcpp2::Data::SubmoduleInitType::COUNT) == 3, 
-                                "Add new type to be processed");
-                switch(git->CurrentSubmoduleInitType)
-                {
-                    case runcpp2::Data::SubmoduleInitType::NONE:
-                        break;
-                    case runcpp2::Data::SubmoduleInitType::SHALLOW:
-                        submoduleString = "--recursive --shallow-submodules ";
-                        break;
-                    case runcpp2::Data::SubmoduleInitType::FULL:
-                        submoduleString = "--recursive ";
-                        break;
-                    default:
-                    {
-                        return DS_ERROR_MSG("Invalid git submodule init type: " +
-                                            DS_STR(static_cast<int>(git->CurrentSubmoduleInitType)));
+                if(entriesCount++ == 0)
+                    firstEntry = it->path();
+            }
+            
+            if(entriesCount == 1 && ghc::filesystem::is_directory(firstEntry, e))
+                rootPath = firstEntry;
+        }
+        
+        //Use the one extracted by other runcpp2 processes if there's any
+        ghc::filesystem::rename(rootPath, extractedPath, e);
+        std::error_code existError;
+        if(e && !ghc::filesystem::is_directory(extractedPath, existError))
+        {
+            return DS_ERROR_MSG("Failed to move extracted archive to " + extractedPath.string() + 
+                                ": " + e.message());
+        }
+        
+        return {};
+    }
+    
+    //NOTE: Gets the directory in the user cache directory shared by all the scripts, and creates 
+    //      it if it doesn't exist
+    bool GetUserCacheDirectory(const std::string& name, ghc::filesystem::path& outDirectory)
+    {
+        ghc::filesystem::path cacheDirectory = runcpp2::GetCacheDirectoryPath().DS_TRY_ACT
+        (
+            ssLOG_WARNING(DS_TMP_ERROR.ToString());
+            return false;
+        );
+        
+        outDirectory = cacheDirectory / name;
+        
+        //NOTE: Other runcpp2 processes could be creating the directory at the same time, so only 
+        //      check if it exists afterwards
+        std::error_code e;
+        ghc::filesystem::create_directories(outDirectory, e);
+        if(!ghc::filesystem::is_directory(outDirectory, e))
+        {
+            ssLOG_WARNING("Failed to create directory: " << outDirectory.string());
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //NOTE: Gets a path next to the given path that is unique across threads and processes, for 
+    //      writing to before renaming it to the given path
+    ghc::filesystem::path GetTemporaryPath(const ghc::filesystem::path& path)
+    {
+        static std::atomic<unsigned int> temporaryCount(0);
+        static const unsigned int processSeed = std::random_device{}();
+        
+        return  path.string() + "." + 
+                std::to_string(processSeed) + "_" + 
+                std::to_string(temporaryCount++) + "_" + 
+                std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    }
+    
+    bool RunGitCommand(const std::string& command, const ghc::filesystem::path& runDirectory)
+    {
+        ssLOG_INFO("Running git command: " << command << " in " << runDirectory.string());
+        
+        int returnCode = 0;
+        std::string output;
+        if(!runcpp2::RunCommand(command, true, runDirectory.string(), output, returnCode))
+        {
+            ssLOG_WARNING(  "Failed to run git command with result: " << returnCode << 
+                            "\nWas trying to run: " << command << "\nOutput: \n" << output);
+            return false;
+        }
+        
+        return true;
+    }
+    
+    bool HasGitCommit(const ghc::filesystem::path& repoPath, const std::string& revision)
+    {
+        int returnCode = 0;
+        std::string output;
+        return runcpp2::RunCommand( "git cat-file -e " + revision + "^{commit}", 
+                                    true, 
+                                    repoPath.string(), 
+                                    output, 
+                                    returnCode);
+    }
+    
+    //NOTE: Gets the paths to checkout for sparse checkout, which are the include paths of the 
+    //      dependency, the directory of the import file and the extra paths. 
+    //      Returns false if sparse checkout is not used, or if the whole repository is needed.
+    bool GetSparseCheckoutPaths(const runcpp2::Data::DependencyInfo& dependency,
+                                const runcpp2::Data::GitSource& git,
+                                std::vector<std::string>& outPaths)
+    {
+        outPaths.clear();
+        if(!git.SparseCheckout)
+            return false;
+        
+        std::vector<std::string> paths = dependency.IncludePaths;
+        paths.insert(paths.end(), git.SparseCheckoutPaths.begin(), git.SparseCheckoutPaths.end());
+        
+        //The files in the repository root are always checked out, so only the directory of the 
+        //import file is needed
+        if(!dependency.Source.ImportPath.empty())
+        {
+            const ghc::filesystem::path importDirectory = 
+                dependency.Source.ImportPath.lexically_normal().parent_path();
+            if(!importDirectory.empty())
+                paths.push_back(importDirectory.generic_string());
+        }
+        
+        for(int i = 0; i < paths.size(); ++i)
+        {
+            std::string path = ghc::filesystem::path(paths.at(i))   .lexically_normal()
+                                                                    .generic_string();
+            while(!path.empty() && path.back() == '/')
+                path.pop_back();
+            
+            if(path.empty() || path == ".")
+            {
+                ssLOG_INFO( "The whole repository is needed for " << dependency.Name << 
+                            ", not using sparse checkout");
+                outPaths.clear();
+                return false;
+            }
+            
+            if(ghc::filesystem::path(path).is_absolute() || path.find("..") == 0)
+            {
+                ssLOG_WARNING(  "Ignoring sparse checkout path outside of the repository for " << 
+                                dependency.Name << ": " << paths.at(i));
+                continue;
+            }
+            
+            outPaths.push_back(path);
+        }
+        
+        if(outPaths.empty())
+        {
+            ssLOG_WARNING(  "No paths to checkout for " << dependency.Name << 
+                            ", not using sparse checkout");
+            return false;
+        }
+        
+        return true;
+    }
+    
+    std::string GetSparseCheckoutCommand(const std::vector<std::string>& sparsePaths)
+    {
+        std::string command = "git sparse-checkout set --cone";
+        for(int i = 0; i < sparsePaths.size(); ++i)
+            command += " \"" + sparsePaths.at(i) + "\"";
+        return command;
+    }
+    
+    //NOTE: Copies cloned from the git mirrors use the objects in the mirrors, which are gone if 
+    //      the mirrors are removed or recreated. Only the directories of the objects are checked 
+    //      if checkObjects is false, which doesn't need to run git.
+    bool IsGitCopyValid(const ghc::filesystem::path& copyPath, const bool checkObjects)
+    {
+        std::error_code e;
+        const ghc::filesystem::path objectsDir = copyPath / ".git" / "objects";
+        std::ifstream alternatesFile((objectsDir / "info" / "alternates").string());
+        std::string line;
+        while(alternatesFile.is_open() && std::getline(alternatesFile, line))
+        {
+            if(line.empty() || line.front() == '#')
+                continue;
+            
+            ghc::filesystem::path alternatePath = line;
+            if(alternatePath.is_relative())
+                alternatePath = objectsDir / alternatePath;
+            
+            if(!ghc::filesystem::is_directory(alternatePath, e))
+            {
+                ssLOG_INFO("Git objects directory " << alternatePath.string() << " is missing");
+                return false;
+            }
+        }
+        
+        if(!checkObjects)
+            return true;
+        
+        int returnCode = 0;
+        std::string output;
+        return runcpp2::RunCommand( "git rev-parse --verify --quiet \"HEAD^{commit}\"", 
+                                    true, 
+                                    copyPath.string(), 
+                                    output, 
+                                    returnCode);
+    }
+    
+    //NOTE: Keeps a bare mirror of each git repository in mirrorsDir, shared by all the scripts. 
+    //      The dependency copy is cloned with --shared so that it uses the objects in the mirror 
+    //      instead of downloading and storing its own. The copy is checked out at the locked 
+    //      revision if it is not empty, and only the sparse paths are checked out if there are 
+    //      any. Returns false if failed, in which case the copy is not created.
+    bool CloneFromGitMirror(const runcpp2::Data::GitSource& git,
+                            const ghc::filesystem::path& copyPath,
+                            const ghc::filesystem::path& buildDir,
+                            const ghc::filesystem::path& mirrorsDir,
+                            const std::string& lockedRevision,
+                            const std::vector<std::string>& sparsePaths)
+    {
+        ssLOG_FUNC_INFO();
+        
+        //The mirror is keyed by the URL, with the repository name to make it easier to find
+        runcpp2::Sha256 urlHash;
+        urlHash.Update(reinterpret_cast<const unsigned char*>(git.URL.data()), git.URL.size());
+        const ghc::filesystem::path mirrorPath = 
+            mirrorsDir / 
+            (copyPath.filename().string() + "_" + urlHash.FinishHex().substr(0, 16) + ".git");
+        
+        std::error_code e;
+        //Fetch the latest commits to the mirror if it exists, otherwise create it.
+        //The remote is not queried if the mirror already has the locked commit.
+        if(ghc::filesystem::exists(mirrorPath / "HEAD", e))
+        {
+            if( (lockedRevision.empty() || !HasGitCommit(mirrorPath, lockedRevision)) &&
+                !RunGitCommand("git fetch --prune origin", mirrorPath))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            //NOTE: Create the mirror in a temporary directory first, so that other runcpp2 
+            //      processes never see a partially created mirror
+            const ghc::filesystem::path tempMirrorPath = GetTemporaryPath(mirrorPath);
+            
+            //Objects can be removed from the mirror when the references are updated, keep them 
+            //since the dependencies copies might still be using them
+            if( !RunGitCommand( "git clone --mirror " + git.URL + " \"" + 
+                                tempMirrorPath.string() + "\"", 
+                                mirrorsDir) ||
+                !RunGitCommand("git config gc.pruneExpire never", tempMirrorPath))
+            {
+                ghc::filesystem::remove_all(tempMirrorPath, e);
+                return false;
+            }
+            
+            //Use the one created by other runcpp2 processes if there's any
+            ghc::filesystem::rename(tempMirrorPath, mirrorPath, e);
+            if(e)
+            {
+                ghc::filesystem::remove_all(tempMirrorPath, e);
+                if(!ghc::filesystem::exists(mirrorPath / "HEAD", e))
+                {
+                    ssLOG_WARNING("Failed to create git mirror: " << mirrorPath.string());
+                    return false;
+                }
+            }
+        }
+        
+        std::string submoduleString;
+        static_assert(  static_cast<int>(runcpp2::Data::SubmoduleInitType::COUNT) == 3, 
+                        "Add new type to be processed");
+        switch(git.CurrentSubmoduleInitType)
+        {
+            case runcpp2::Data::SubmoduleInitType::NONE:
+                break;
+            case runcpp2::Data::SubmoduleInitType::SHALLOW:
+                submoduleString = "git submodule update --init --recursive --depth 1";
+                break;
+            case runcpp2::Data::SubmoduleInitType::FULL:
+                submoduleString = "git submodule update --init --recursive";
+                break;
+            default:
+            {
+                ssLOG_WARNING(  "Invalid git submodule init type: " << 
+                                static_cast<int>(git.CurrentSubmoduleInitType));
+                return false;
+            }
+        }
+        
+        //NOTE: FullHistory doesn't matter here since the objects are not copied from the mirror
+        const std::string gitCloneCommand = 
+            std::string("git clone --shared ") + 
+            (sparsePaths.empty() ? "" : "--sparse ") +
+            (git.Branch.empty() ? std::string("") : std::string("--branch ") + git.Branch + " ") +
+            "\"" + mirrorPath.string() + "\" \"" + copyPath.string() + "\"";
+        
+        //Point the copy back to the repository instead of the mirror, which is also needed for
+        //relative submodule URLs
+        if( !RunGitCommand(gitCloneCommand, buildDir) ||
+            !RunGitCommand("git remote set-url origin " + git.URL, copyPath) ||
+            (
+                !sparsePaths.empty() && 
+                !RunGitCommand(GetSparseCheckoutCommand(sparsePaths), copyPath)
+            ) ||
+            (
+                !lockedRevision.empty() && 
+                !RunGitCommand("git checkout --quiet --detach " + lockedRevision, copyPath)
+            ) ||
+            (!submoduleString.empty() && !RunGitCommand(submoduleString, copyPath)))
+        {
+            ghc::filesystem::remove_all(copyPath, e);
+            return false;
+        }
+        
+        return true;
+    }
+    
+    DS::Result<void> PopulateLocalDependency(   const runcpp2::Data::DependencyInfo& dependency,
+                                                const ghc::filesystem::path& copyPath,
+                                                const ghc::filesystem::path& sourcePath,
+                                                const ghc::filesystem::path& buildDir,
+                                                const std::string& lockedRevision,
+                                                bool& outPrePopulated)
+    {
+        ssLOG_FUNC_INFO();
+        
+        std::error_code e;
+        
+        const runcpp2::Data::GitSource* git = 
+            mpark::get_if<runcpp2::Data::GitSource>(&(dependency.Source.Source));
+        std::vector<std::string> sparsePaths;
+        if(git)
+            GetSparseCheckoutPaths(dependency, *git, sparsePaths);
+        
+        //Clone the copy again if it can't be used anymore, such as when the git mirror is removed
+        if(git && ghc::filesystem::is_directory(copyPath, e) && !IsGitCopyValid(copyPath, true))
+        {
+            ssLOG_WARNING(  "Dependency copy " << copyPath.string() << " is broken, " << 
+                            "cloning it again");
+            ghc::filesystem::remove_all(copyPath, e);
+            if(e)
+            {
+                return DS_ERROR_MSG("Failed to remove dependency copy " + copyPath.string() + 
+                                    ": " + e.message());
+            }
+        }
+        
+        if(ghc::filesystem::exists(copyPath, e))
+        {
+            if(!ghc::filesystem::is_directory(copyPath, e))
+            {
+                return DS_ERROR_MSG("Dependency path is a file: " + copyPath.string() + "\n" +
+                                    "It should be a folder instead");
+            }
+            
+            //Dependencies cloned for importing only have the directory of the import file, 
+            //checkout the other paths if they are missing
+            for(int i = 0; i < sparsePaths.size(); ++i)
+            {
+                if(ghc::filesystem::exists(copyPath / sparsePaths.at(i), e))
+                    continue;
+                
+                if(!RunGitCommand(GetSparseCheckoutCommand(sparsePaths), copyPath))
+                {
+                    return DS_ERROR_MSG("Failed to update sparse checkout paths for " + 
+                                        dependency.Name);
+                }
+                break;
+            }
+            
+            outPrePopulated = true;
+            return {};
+        }
+        else
+        {
+            if(git)
+            {
+                //Clone from the mirror shared by all the scripts if possible, so that only new 
+                //commits are downloaded and the objects are not duplicated for each script.
+                //The mirror has all the files, which defeats the purpose of partial clones.
+                ghc::filesystem::path mirrorsDir;
+                if( !git->PartialClone && 
+                    GetUserCacheDirectory("GitMirrors", mirrorsDir) &&
+                    CloneFromGitMirror( *git, 
+                                        copyPath, 
+                                        buildDir, 
+                                        mirrorsDir, 
+                                        lockedRevision, 
+                                        sparsePaths))
+                {
+                    outPrePopulated = false;
+                    return {};
+                }
+                
+                if(!git->PartialClone)
+                {
+                    ssLOG_WARNING(  "Failed to clone " << git->URL << " from git mirror, " <<
+                                    "cloning it directly instead");
+                }
+                
+                std::string submoduleString;
+                static_assert(  static_cast<int>(runcpp2::Data::SubmoduleInitType::COUNT) == 3, 
+                                "Add new type to be processed");
+                switch(git->CurrentSubmoduleInitType)
+                {
+                    case runcpp2::Data::SubmoduleInitType::NONE:
+                        break;
+                    case runcpp2::Data::SubmoduleInitType::SHALLOW:
+                        submoduleString = "--recursive --shallow-submodules ";
+                        break;
+                    case runcpp2::Data::SubmoduleInitType::FULL:
+                        submoduleString = "--recursive ";
+                        break;
+                    default:
+                    {
+                        return DS_ERROR_MSG("Invalid git submodule init type: " +
+                                            DS_STR(static_cast<int>(git->CurrentSubmoduleInitType)));
                     }
                 }
                 
@@ -1172,6 +2184,8 @@ namespace
                     std::string("git clone ") + 
                     submoduleString + 
                     (git->FullHistory ? "" : "--depth 1 ") + 
+                    (git->PartialClone ? "--filter=blob:none " : "") +
+                    (sparsePaths.empty() ? "" : "--sparse ") + 
                     (
                         git->Branch.empty() ? 
                         std::string("") : 
@@ -1195,10 +2209,43 @@ namespace
                 }
                 //else
                 //    ssLOG_INFO("Output: \n" << output);
+                
+                if( !sparsePaths.empty() && 
+                    !RunGitCommand(GetSparseCheckoutCommand(sparsePaths), copyPath))
+                {
+                    return DS_ERROR_MSG("Failed to set sparse checkout paths for " + 
+                                        dependency.Name);
+                }
+                
+                //Checkout the locked revision, which needs to be fetched first for shallow clones
+                if(!lockedRevision.empty())
+                {
+                    const bool shallowSubmodules = 
+                        git->CurrentSubmoduleInitType == runcpp2::Data::SubmoduleInitType::SHALLOW;
+                    
+                    if( (
+                            !git->FullHistory && 
+                            !RunGitCommand("git fetch --depth 1 origin " + lockedRevision, copyPath)
+                        ) ||
+                        !RunGitCommand( "git checkout --quiet --detach " + lockedRevision, 
+                                        copyPath) ||
+                        (
+                            !submoduleString.empty() &&
+                            !RunGitCommand( std::string("git submodule update --init --recursive") +
+                                            (shallowSubmodules ? " --depth 1" : ""),
+                                            copyPath)
+                        ))
+                    {
+                        return DS_ERROR_MSG("Failed to checkout " + git->URL + " at the locked "
+                                            "revision " + lockedRevision + ". Maybe try "
+                                            "refreshing the lockfile with `runcpp2 lock`?");
+                    }
+                }
             }
-            else if(mpark::get_if<runcpp2::Data::LocalSource>(&(dependency.Source.Source)))
+            else if(mpark::get_if<runcpp2::Data::LocalSource>(&(dependency.Source.Source)) ||
+                    mpark::get_if<runcpp2::Data::ArchiveSource>(&(dependency.Source.Source)))
             {
-                //Copy/link local directory if it doesn't have any import path
+                //Copy/link local or extracted archive directory if it doesn't have any import path
                 if(dependency.Source.ImportPath.empty())
                 {
                     runcpp2::SyncLocalDependency(dependency, sourcePath, copyPath).DS_TRY();
@@ -1215,6 +2262,7 @@ namespace
                                 const std::vector<std::string>& dependenciesCopiesPaths,
                                 const std::vector<std::string>& dependenciesSourcesPaths,
                                 const ghc::filesystem::path& buildDir,
+                                const runcpp2::Data::DependenciesLock& lock,
                                 std::vector<bool>& outPrePopulated)
     {
         ssLOG_FUNC_INFO();
@@ -1226,11 +2274,14 @@ namespace
             if(!dependencies.at(i)->Source.ImportPath.empty())
                 return DS_ERROR_MSG("Dependency import not resolved before populating.");
             
+            const std::string* lockedRevision = GetLockedRevision(lock, *dependencies.at(i));
+            
             bool prePopulated = false;
             PopulateLocalDependency(*dependencies.at(i),
                                     ghc::filesystem::path(dependenciesCopiesPaths.at(i)),
                                     ghc::filesystem::path(dependenciesSourcesPaths.at(i)),
                                     buildDir,
+                                    lockedRevision == nullptr ? "" : *lockedRevision,
                                     prePopulated).DS_TRY();
             outPrePopulated.at(i) = prePopulated;
         }
@@ -1280,7 +2331,8 @@ namespace
                                                         runcpp2::Data::ProfilesCommands> steps,
                             const std::string& dependenciesCopiedDirectory,
                             bool required,
-                            bool redirectIO)
+                            bool redirectIO,
+                            const runcpp2::Jobserver* jobserver)
     {
         ssLOG_FUNC_INFO();
         
@@ -1322,7 +2374,10 @@ namespace
                                     redirectIO,
                                     processedDependencyPath,
                                     output, 
-                                    returnCode))
+                                    returnCode,
+                                    nullptr,
+                                    nullptr,
+                                    jobserver))
             {
                 std::string errorMsg = 
                     DS_STR("Failed to run command with result: ") + DS_STR(returnCode) + "\n"
@@ -1423,6 +2478,738 @@ namespace
         
         return resolvedPath;
     }
+    
+    //NOTE: Lists the search directory the first time it is used and returns the same index after.
+    //      Invalid search directories have an empty index.
+    const SearchDirectoryIndex& 
+    GetSearchDirectoryIndex(const std::string& searchDirectory,
+                            std::unordered_map<std::string, SearchDirectoryIndex>& inOutIndices)
+    {
+        const std::string processedDirectory = runcpp2::ProcessPath(searchDirectory);
+        auto foundIndex = inOutIndices.find(processedDirectory);
+        if(foundIndex != inOutIndices.end())
+            return foundIndex->second;
+        
+        SearchDirectoryIndex& index = inOutIndices[processedDirectory];
+        
+        std::error_code e;
+        if( !ghc::filesystem::exists(searchDirectory, e) || 
+            !ghc::filesystem::is_directory(searchDirectory, e))
+        {
+            ssLOG_INFO("Invalid search path: " << searchDirectory);
+            return index;
+        }
+        
+        for(auto it : ghc::filesystem::directory_iterator(searchDirectory, e))
+        {
+            if(it.is_directory(e))
+                continue;
+            
+            const std::string extension = runcpp2::GetFileExtensionWithoutVersion(it.path());
+            ssLOG_DEBUG("Indexing " << it.path().string() << " with extension " << extension);
+            index[extension].push_back(it.path());
+        }
+        
+        return index;
+    }
+    
+    //NOTE: Each line is "<size or symlink target>|<write time>|<relative path>"
+    bool ReadSyncManifest(  const ghc::filesystem::path& manifestPath,
+                            std::unordered_map<std::string, std::string>& outEntries)
+    {
+        INTERNAL_RUNCPP2_SAFE_START();
+        
+        outEntries.clear();
+        std::ifstream manifestFile(manifestPath);
+        if(!manifestFile.is_open())
+            return false;
+        
+        std::string line;
+        while(std::getline(manifestFile, line))
+        {
+            const std::size_t sizeEnd = line.find('|');
+            const std::size_t timeEnd = 
+                sizeEnd == std::string::npos ? std::string::npos : line.find('|', sizeEnd + 1);
+            if(timeEnd == std::string::npos)
+                continue;
+            
+            outEntries[line.substr(timeEnd + 1)] = line.substr(0, timeEnd);
+        }
+        
+        return true;
+        INTERNAL_RUNCPP2_SAFE_CATCH_RETURN(false);
+    }
+    
+    bool WriteSyncManifest( const ghc::filesystem::path& manifestPath,
+                            const std::unordered_map<std::string, std::string>& entries)
+    {
+        INTERNAL_RUNCPP2_SAFE_START();
+        
+        std::ofstream manifestFile(manifestPath);
+        if(!manifestFile.is_open())
+            return false;
+        
+        for(auto it = entries.begin(); it != entries.end(); ++it)
+            manifestFile << it->second << "|" << it->first << "\n";
+        
+        manifestFile.close();
+        return !manifestFile.fail();
+        INTERNAL_RUNCPP2_SAFE_CATCH_RETURN(false);
+    }
+    
+    //NOTE: Links or copies the file if it has changed since the last sync
+    DS::Result<void> 
+    SyncLocalFile(  runcpp2::Data::LocalCopyMode copyMode,
+                    const ghc::filesystem::path& srcPath,
+                    const ghc::filesystem::path& targetPath,
+                    const std::string& relativePath,
+                    const std::unordered_map<std::string, std::string>& lastManifest,
+                    std::unordered_map<std::string, std::string>& inOutNewManifest)
+    {
+        std::error_code ec;
+        std::string fileKey;
+        if(!GetSyncFileKey(srcPath, fileKey))
+            return DS_ERROR_MSG(srcPath.string() + " Failed to read file");
+        
+        const bool srcIsSymlink = ghc::filesystem::is_symlink(srcPath, ec);
+        inOutNewManifest[relativePath] = fileKey;
+        
+        const bool targetExists = 
+            ghc::filesystem::exists(ghc::filesystem::symlink_status(targetPath, ec));
+        if( targetExists && 
+            lastManifest.count(relativePath) > 0 && 
+            lastManifest.at(relativePath) == fileKey)
+        {
+            return {};
+        }
+        
+        ssLOG_DEBUG("Updating: " << targetPath.string());
+        if(targetExists)
+        {
+            ghc::filesystem::remove_all(targetPath, ec);
+            if(ec)
+                return DS_ERROR_MSG(ec.message());
+        }
+        
+        const ghc::filesystem::copy_options copyOptions = 
+            ghc::filesystem::copy_options::overwrite_existing |
+            ghc::filesystem::copy_options::copy_symlinks;
+        
+        switch(copyMode)
+        {
+            case runcpp2::Data::LocalCopyMode::Auto:
+                ghc::filesystem::create_symlink(srcPath, targetPath, ec);
+                if(ec)
+                {
+                    ssLOG_DEBUG("Symlink failed: " << ec.message());
+                    ec.clear();
+                    ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
+                    if(ec)
+                    {
+                        ssLOG_DEBUG("Hardlink failed: " << ec.message());
+                        ec.clear();
+                        if(srcIsSymlink)
+                            ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
+                        else
+                            runcpp2::CloneOrCopyFile(srcPath, targetPath, ec);
+                    }
+                }
+                break;
+            
+            case runcpp2::Data::LocalCopyMode::Symlink:
+                ghc::filesystem::create_symlink(srcPath, targetPath, ec);
+                break;
+            
+            case runcpp2::Data::LocalCopyMode::Hardlink:
+                ghc::filesystem::create_hard_link(srcPath, targetPath, ec);
+                break;
+            
+            case runcpp2::Data::LocalCopyMode::Copy:
+                //Symlinks are copied as they are, files are reflinked if possible
+                if(srcIsSymlink)
+                    ghc::filesystem::copy(srcPath, targetPath, copyOptions, ec);
+                else
+                    runcpp2::CloneOrCopyFile(srcPath, targetPath, ec);
+                break;
+            
+            default:
+                return DS_ERROR_MSG("Invalid copy mode: " + DS_STR(static_cast<int>(copyMode)));
+        }
+        
+        if(ec)
+            return DS_ERROR_MSG("Failed to update target: " + ec.message());
+        
+        return {};
+    }
+    
+    //NOTE: The key is "<size or symlink target>|<write time>", which is used for checking if the 
+    //      file has changed since the last sync
+    bool GetSyncFileKey(const ghc::filesystem::path& srcPath, std::string& outKey)
+    {
+        std::error_code ec;
+        if(ghc::filesystem::is_symlink(srcPath, ec))
+            outKey = ghc::filesystem::read_symlink(srcPath, ec).generic_string() + "|0";
+        else
+        {
+            outKey =    std::to_string(ghc::filesystem::file_size(srcPath, ec)) + "|" + 
+                        std::to_string(ghc::filesystem::last_write_time(srcPath, ec)
+                                                                        .time_since_epoch()
+                                                                        .count());
+        }
+        
+        if(ec)
+            return false;
+        
+        //The file key can't contain the separator before the path
+        if(outKey.find('|') != outKey.rfind('|'))
+            outKey = "Changed|0";
+        
+        return true;
+    }
+    
+    //NOTE: Adds the file or all the files in the directory to the manifest without syncing them, 
+    //      for the ones that are linked or used in place
+    DS::Result<void> 
+    AddToSyncManifest(  const ghc::filesystem::path& srcPath,
+                        const ghc::filesystem::path& sourcePath,
+                        std::unordered_map<std::string, std::string>& inOutManifest)
+    {
+        std::error_code ec;
+        std::string fileKey;
+        if(!ghc::filesystem::is_directory(srcPath, ec) || ghc::filesystem::is_symlink(srcPath, ec))
+        {
+            if(!GetSyncFileKey(srcPath, fileKey))
+                return DS_ERROR_MSG(srcPath.string() + " Failed to read file");
+            
+            inOutManifest[srcPath.lexically_relative(sourcePath).generic_string()] = fileKey;
+            return {};
+        }
+        
+        inOutManifest[srcPath.lexically_relative(sourcePath).generic_string()] = "Directory|0";
+        using DirIt = ghc::filesystem::recursive_directory_iterator;
+        for(DirIt it(srcPath, ec); !ec && it != DirIt(); it.increment(ec))
+        {
+            const std::string relativePath = 
+                it->path().lexically_relative(sourcePath).generic_string();
+            if(it->is_directory(ec) && !it->is_symlink(ec))
+            {
+                inOutManifest[relativePath] = "Directory|0";
+                continue;
+            }
+            
+            if(!GetSyncFileKey(it->path(), fileKey))
+                return DS_ERROR_MSG(it->path().string() + " Failed to read file");
+            
+            inOutManifest[relativePath] = fileKey;
+        }
+        
+        if(ec)
+            return DS_ERROR_MSG(srcPath.string() + " Failed: " + ec.message());
+        
+        return {};
+    }
+    
+    std::string 
+    GetSyncManifestRevision(const std::unordered_map<std::string, std::string>& manifest)
+    {
+        //Sorted so that the revision doesn't depend on the order of the entries
+        std::vector<std::string> entries;
+        entries.reserve(manifest.size());
+        for(auto it = manifest.begin(); it != manifest.end(); ++it)
+            entries.push_back(it->second + "|" + it->first + "\n");
+        std::sort(entries.begin(), entries.end());
+        
+        runcpp2::Sha256 hash;
+        for(int i = 0; i < entries.size(); ++i)
+        {
+            hash.Update(reinterpret_cast<const unsigned char*>(entries.at(i).data()), 
+                        entries.at(i).size());
+        }
+        return hash.FinishHex();
+    }
+    
+    //NOTE: The revision is the checked out commit for git dependencies and the archive hash for 
+    //      archive dependencies. The revisions of local dependencies are from syncing them instead.
+    bool GetDependencyRevision( const runcpp2::Data::DependencyInfo& dependency,
+                                const ghc::filesystem::path& copyPath,
+                                std::string& outRevision)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        const runcpp2::Data::DependencySource& source = dependency.Source;
+        if(mpark::get_if<runcpp2::Data::GitSource>(&(source.Source)))
+        {
+            int returnCode = 0;
+            if(!runcpp2::RunCommand("git rev-parse HEAD", 
+                                    true, 
+                                    copyPath.string(), 
+                                    outRevision, 
+                                    returnCode))
+            {
+                return false;
+            }
+            
+            runcpp2::Trim(outRevision);
+            return !outRevision.empty();
+        }
+        else if(mpark::get_if<runcpp2::Data::ArchiveSource>(&(source.Source)))
+        {
+            outRevision = mpark::get_if<runcpp2::Data::ArchiveSource>(&(source.Source))->SHA256;
+            return true;
+        }
+        
+        return false;
+    }
+    
+    //NOTE: Gets the latest commit of the branch or tag, or the default branch if not specified, 
+    //      without cloning the repository
+    bool GetRemoteGitRevision(const runcpp2::Data::GitSource& git, std::string& outRevision)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        //The references are listed explicitly in the order of preference, since ls-remote matches 
+        //any reference ending with the pattern (e.g. refs/heads/feature/main for main). 
+        //Annotated tags have an extra reference ending with ^{} for the commit they point to.
+        std::vector<std::string> references;
+        if(git.Branch.empty())
+            references.push_back("HEAD");
+        else
+        {
+            references.push_back("refs/heads/" + git.Branch);
+            references.push_back("refs/tags/" + git.Branch + "^{}");
+            references.push_back("refs/tags/" + git.Branch);
+        }
+        
+        std::string command = "git ls-remote " + git.URL;
+        for(int i = 0; i < references.size(); ++i)
+            command += " \"" + references.at(i) + "\"";
+        
+        int returnCode = 0;
+        std::string output;
+        if(!runcpp2::RunCommand(command, true, "", output, returnCode))
+        {
+            ssLOG_WARNING(  "Failed to run git command with result: " << returnCode << 
+                            "\nWas trying to run: " << command << "\nOutput: \n" << output);
+            return false;
+        }
+        
+        //Each line is "<commit>\t<reference>"
+        std::unordered_map<std::string, std::string> referencesCommits;
+        std::stringstream outputStream(output);
+        std::string line;
+        while(std::getline(outputStream, line))
+        {
+            const size_t tabIndex = line.find('\t');
+            if(tabIndex == std::string::npos)
+                continue;
+            
+            std::string reference = line.substr(tabIndex + 1);
+            runcpp2::Trim(reference);
+            referencesCommits[reference] = line.substr(0, tabIndex);
+        }
+        
+        outRevision.clear();
+        for(int i = 0; i < references.size() && outRevision.empty(); ++i)
+        {
+            if(referencesCommits.count(references.at(i)) > 0)
+                outRevision = referencesCommits.at(references.at(i));
+        }
+        
+        runcpp2::Trim(outRevision);
+        if(outRevision.empty())
+        {
+            ssLOG_WARNING(  "Failed to find " << (git.Branch.empty() ? "HEAD" : git.Branch) << 
+                            " in " << git.URL);
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //NOTE: Gets the locked revisions of the dependencies that are still in the script
+    void GetScriptDependenciesLock( const runcpp2::Data::ScriptInfo& scriptInfo,
+                                    const runcpp2::Data::DependenciesLock& lock,
+                                    runcpp2::Data::DependenciesLock& outScriptLock)
+    {
+        outScriptLock = runcpp2::Data::DependenciesLock();
+        for(int i = 0; i < scriptInfo.Dependencies.size(); ++i)
+        {
+            std::map<std::string, runcpp2::Data::LockedRevision>::const_iterator lockedIt = 
+                lock.Revisions.find(scriptInfo.Dependencies.at(i).Name);
+            
+            if(lockedIt != lock.Revisions.end())
+                outScriptLock.Revisions.insert(*lockedIt);
+        }
+    }
+    
+    //NOTE: Returns false if the dependency is not locked, which are local dependencies
+    bool GetDependencyLockSource(   const runcpp2::Data::DependencyInfo& dependency, 
+                                    std::string& outSource)
+    {
+        const runcpp2::Data::DependencySource& source = dependency.Source;
+        if(mpark::get_if<runcpp2::Data::GitSource>(&(source.Source)))
+        {
+            const runcpp2::Data::GitSource* git = 
+                mpark::get_if<runcpp2::Data::GitSource>(&(source.Source));
+            outSource = git->URL + (git->Branch.empty() ? "" : "#" + git->Branch);
+            return true;
+        }
+        else if(mpark::get_if<runcpp2::Data::ArchiveSource>(&(source.Source)))
+        {
+            outSource = mpark::get_if<runcpp2::Data::ArchiveSource>(&(source.Source))->Path;
+            return true;
+        }
+        
+        return false;
+    }
+    
+    //NOTE: Returns nullptr if the dependency is not locked, or locked with a different source
+    const std::string* GetLockedRevision(   const runcpp2::Data::DependenciesLock& lock,
+                                            const runcpp2::Data::DependencyInfo& dependency)
+    {
+        std::map<std::string, runcpp2::Data::LockedRevision>::const_iterator lockedIt = 
+            lock.Revisions.find(dependency.Name);
+        
+        std::string source;
+        if( lockedIt == lock.Revisions.end() || 
+            !GetDependencyLockSource(dependency, source))
+        {
+            return nullptr;
+        }
+        
+        if(lockedIt->second.Source != source)
+        {
+            ssLOG_INFO( dependency.Name << " is locked with a different source " << 
+                        lockedIt->second.Source << ", ignoring the locked revision");
+            return nullptr;
+        }
+        
+        return &(lockedIt->second.Revision);
+    }
+    
+    //NOTE: The key covers the profile, the dependency settings including the setup and build 
+    //      commands, and the revision of the dependency.
+    //      Returns false if the dependency should not be cached
+    bool GetDependencyCacheKey( const runcpp2::Data::Profile& profile,
+                                const runcpp2::Data::DependencyInfo& dependency,
+                                const std::string& revision,
+                                std::string& outCacheKey)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        //Nothing to cache if there's nothing to build
+        if( dependency.LibraryType == runcpp2::Data::DependencyLibraryType::HEADER ||
+            !runcpp2::HasValueFromPlatformMap(dependency.Build))
+        {
+            return false;
+        }
+        
+        if(revision.empty())
+        {
+            ssLOG_WARNING(  "Unknown revision for " << dependency.Name << 
+                            ", not caching build artifacts");
+            return false;
+        }
+        
+        const std::string keyString =   profile.ToString("") + 
+                                        dependency.ToString("") + 
+                                        revision;
+        outCacheKey = dependency.Name + "_" + std::to_string(std::hash<std::string>{}(keyString));
+        return true;
+    }
+    
+    std::string GetDependencyReadyKey(  const runcpp2::Data::Profile& profile,
+                                        const runcpp2::Data::DependencyInfo& dependency)
+    {
+        const std::string keyString = profile.ToString("") + dependency.ToString("");
+        return std::to_string(std::hash<std::string>{}(keyString));
+    }
+    
+    //NOTE: The records are left empty if they don't exist or failed to be read, in which case 
+    //      none of the dependencies are ready
+    void 
+    ReadDependenciesReadyRecords(   const ghc::filesystem::path& buildDir,
+                                    std::map<   std::string, 
+                                                runcpp2::Data::DependencyReadyRecord>& outRecords)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        outRecords.clear();
+        
+        std::error_code e;
+        const ghc::filesystem::path recordsPath = buildDir / "DependenciesReady.yaml";
+        if(!ghc::filesystem::exists(recordsPath, e))
+            return;
+        
+        std::string content;
+        {
+            std::ifstream recordsFile(recordsPath.string());
+            if(!recordsFile.is_open())
+            {
+                ssLOG_WARNING("Failed to open dependencies records: " << recordsPath.string());
+                return;
+            }
+            
+            std::stringstream buffer;
+            buffer << recordsFile.rdbuf();
+            content = buffer.str();
+        }
+        
+        runcpp2::YAML::ResourceHandle resource;
+        std::vector<runcpp2::YAML::NodePtr> rootNodes = 
+            runcpp2::YAML::ParseYAML(content, resource).DS_TRY_ACT
+            (
+                ssLOG_WARNING(DS_TMP_ERROR.ToString());
+                return
+            );
+        DEFER { runcpp2::YAML::FreeYAMLResource(resource); };
+        
+        if(rootNodes.empty() || !rootNodes.front()->IsMap())
+            return;
+        
+        for(int i = 0; i < rootNodes.front()->GetChildrenCount(); ++i)
+        {
+            runcpp2::Data::DependencyReadyRecord record;
+            std::string name = rootNodes.front()->GetMapKeyScalarAt<std::string>(i).DS_TRY_ACT
+            (
+                ssLOG_WARNING(DS_TMP_ERROR.ToString());
+                outRecords.clear();
+                return
+            );
+            
+            if(!record.ParseYAML_Node(rootNodes.front()->GetMapValueNodeAt(i)))
+            {
+                ssLOG_WARNING("Failed to parse dependencies records: " << recordsPath.string());
+                outRecords.clear();
+                return;
+            }
+            
+            outRecords[name] = record;
+        }
+    }
+    
+    //NOTE: Copies the cached artifacts to the dependency if there's any. Files that are already 
+    //      the same are skipped, and existing files are removed before copying so that hardlinked 
+    //      files are not modified.
+    bool RestoreDependencyArtifacts(const std::string& cacheKey, 
+                                    const ghc::filesystem::path& copyPath)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        ghc::filesystem::path cacheDir;
+        if(!GetUserCacheDirectory("DependenciesCache", cacheDir))
+            return false;
+        
+        const ghc::filesystem::path artifactsDir = cacheDir / cacheKey;
+        std::error_code e;
+        if(!ghc::filesystem::is_directory(artifactsDir, e))
+            return false;
+        
+        ghc::filesystem::recursive_directory_iterator it(artifactsDir, e);
+        const ghc::filesystem::recursive_directory_iterator end;
+        for(; !e && it != end; it.increment(e))
+        {
+            const ghc::filesystem::path destPath = 
+                copyPath / it->path().lexically_relative(artifactsDir);
+            
+            if(it->is_directory(e) && !it->is_symlink(e))
+            {
+                if(!ghc::filesystem::is_directory(destPath, e))
+                    ghc::filesystem::create_directories(destPath, e);
+            }
+            else if(it->is_symlink(e))
+            {
+                const ghc::filesystem::path target = ghc::filesystem::read_symlink(it->path(), e);
+                if( !e &&
+                    ghc::filesystem::is_symlink(ghc::filesystem::symlink_status(destPath, e)) &&
+                    ghc::filesystem::read_symlink(destPath, e) == target)
+                {
+                    continue;
+                }
+                
+                ghc::filesystem::remove(destPath, e);
+                ghc::filesystem::create_symlink(target, destPath, e);
+            }
+            else
+            {
+                std::error_code destError;
+                if( ghc::filesystem::is_regular_file(destPath, destError) &&
+                    ghc::filesystem::file_size(destPath, destError) == it->file_size(e) &&
+                    ghc::filesystem::last_write_time(destPath, destError) >= 
+                        it->last_write_time(e))
+                {
+                    continue;
+                }
+                
+                ghc::filesystem::remove(destPath, destError);
+                runcpp2::CloneOrCopyFile(it->path(), destPath, e);
+            }
+            
+            if(e)
+                break;
+        }
+        
+        if(e)
+        {
+            ssLOG_WARNING(  "Failed to restore cached build artifacts from " << 
+                            artifactsDir.string() << ": " << e.message());
+            return false;
+        }
+        
+        return true;
+    }
+    
+    //NOTE: Caches the files to link and copy for the dependency. Dependencies with files outside 
+    //      of the dependency directory are not cached.
+    bool StoreDependencyArtifacts(  const runcpp2::Data::Profile& profile,
+                                    runcpp2::Data::DependencyInfo& dependency,
+                                    const ghc::filesystem::path& copyPath,
+                                    const std::string& cacheKey)
+    {
+        ssLOG_FUNC_DEBUG();
+        
+        const std::vector<runcpp2::Data::DependencyInfo*> dependencies = { &dependency };
+        const std::vector<std::string> copiesPaths = { copyPath.string() };
+        std::vector<std::string> artifactsPaths;
+        runcpp2::GatherDependenciesBinaries(dependencies, 
+                                            copiesPaths, 
+                                            profile, 
+                                            artifactsPaths).DS_TRY_ACT
+        (
+            ssLOG_WARNING(DS_TMP_ERROR.ToString());
+            return false;
+        );
+        
+        if(artifactsPaths.empty())
+            return false;
+        
+        //Get the relative paths of the artifacts and the files they are linked to
+        std::error_code e;
+        std::vector<ghc::filesystem::path> relativePaths;
+        for(int i = 0; i < artifactsPaths.size(); ++i)
+        {
+            const ghc::filesystem::path artifactPath = artifactsPaths.at(i);
+            relativePaths.push_back(artifactPath.lexically_relative(copyPath));
+            
+            if(ghc::filesystem::is_symlink(ghc::filesystem::symlink_status(artifactPath, e)))
+            {
+                const ghc::filesystem::path resolvedPath = ResolveSymlink(artifactPath, e);
+                if(e)
+                    return false;
+                relativePaths.push_back(resolvedPath.lexically_relative(copyPath));
+            }
+        }
+        
+        for(int i = 0; i < relativePaths.size(); ++i)
+        {
+            if(relativePaths.at(i).empty() || *relativePaths.at(i).begin() == "..")
+            {
+                ssLOG_INFO( "Not caching build artifacts for " << dependency.Name << 
+                            " since they are outside of " << copyPath.string());
+                return false;
+            }
+        }
+        
+        ghc::filesystem::path cacheDir;
+        if(!GetUserCacheDirectory("DependenciesCache", cacheDir))
+            return false;
+        
+        const ghc::filesystem::path artifactsDir = cacheDir / cacheKey;
+        if(ghc::filesystem::exists(artifactsDir, e))
+            return true;
+        
+        //NOTE: Store the artifacts in a temporary directory first, so that other runcpp2 
+        //      processes never see partially cached artifacts
+        const ghc::filesystem::path tempArtifactsDir = GetTemporaryPath(artifactsDir);
+        
+        for(int i = 0; i < relativePaths.size() && !e; ++i)
+        {
+            const ghc::filesystem::path srcPath = copyPath / relativePaths.at(i);
+            const ghc::filesystem::path destPath = tempArtifactsDir / relativePaths.at(i);
+            if(ghc::filesystem::exists(ghc::filesystem::symlink_status(destPath, e)))
+                continue;
+            
+            ghc::filesystem::create_directories(destPath.parent_path(), e);
+            if(e)
+                break;
+            
+            if(ghc::filesystem::is_symlink(srcPath, e))
+            {
+                ghc::filesystem::copy(  srcPath, 
+                                        destPath, 
+                                        ghc::filesystem::copy_options::copy_symlinks, 
+                                        e);
+            }
+            else
+                runcpp2::CloneOrCopyFile(srcPath, destPath, e);
+        }
+        
+        if(!e)
+            ghc::filesystem::rename(tempArtifactsDir, artifactsDir, e);
+        
+        if(e)
+        {
+            std::error_code removeError;
+            ghc::filesystem::remove_all(tempArtifactsDir, removeError);
+            
+            //Other runcpp2 processes could have cached the same artifacts already
+            if(ghc::filesystem::exists(artifactsDir, removeError))
+                return true;
+            
+            ssLOG_WARNING(  "Failed to cache build artifacts to " << artifactsDir.string() << 
+                            ": " << e.message());
+            return false;
+        }
+        
+        ssLOG_INFO("Cached build artifacts for " << dependency.Name << " to " << 
+                    artifactsDir.string());
+        return true;
+    }
+    
+    DS::Result<void> 
+    WaitForDependenciesJobs(std::vector<std::future<DS::Result<void>>>& actions,
+                            const std::string& stepName)
+    {
+        //NOTE: All the jobs must be finished before returning since they are referencing 
+        //      the caller's variables, only the first error is returned
+        DS::Result<void> firstError = {};
+        for(int i = 0; i < actions.size(); ++i)
+        {
+            if(!actions.at(i).valid())
+            {
+                if(firstError.HasValue())
+                    firstError = DS_ERROR_MSG("Failed to construct actions for " + stepName);
+                continue;
+            }
+            
+            while(actions.at(i).wait_for(std::chrono::seconds(30)) == std::future_status::timeout)
+            {
+                ssLOG_WARNING("Manual interrupt might be needed");
+                ssLOG_WARNING("Waited 30 seconds, dependencies " << stepName << " still going...");
+            }
+            
+            DS::Result<void> actionResult = actions.at(i).get();
+            if(!actionResult.HasValue() && firstError.HasValue())
+            {
+                actionResult.Error().Message += "\n" + stepName + " failed for dependencies";
+                DS_APPEND_TRACE(actionResult.Error());
+                firstError = actionResult;
+            }
+        }
+        
+        return firstError;
+    }
+    
+    DS::Result<void> 
+    GetAvailableDependenciesWaves(  const std::vector<runcpp2::Data::DependencyInfo*>& dependencies,
+                                    std::vector<std::vector<int>>& outWaves)
+    {
+        std::vector<const runcpp2::Data::DependencyInfo*> constDependencies;
+        for(int i = 0; i < dependencies.size(); ++i)
+            constDependencies.push_back(dependencies.at(i));
+        
+        return runcpp2::Data::GetDependenciesWaves(constDependencies, outWaves);
+    }
 }
 
 #endif
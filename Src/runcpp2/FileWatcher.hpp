@@ -0,0 +1,330 @@
+#ifndef RUNCPP2_FILE_WATCHER_HPP
+#define RUNCPP2_FILE_WATCHER_HPP
+
+#if !defined(NOMINMAX)
+    #define NOMINMAX 1
+#endif
+
+#include "ssLogger/ssLog.hpp"
+#include "ghc/filesystem.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string.h>
+
+#if defined(__linux__)
+    #include <errno.h>
+    #include <poll.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace runcpp2
+{
+    //NOTE: Waits for changes in files and directories with inotify. The directories containing the
+    //      files are watched instead of the files themselves, so that editors replacing the files
+    //      when saving are still detected. Only supported on Linux, callers need to poll for
+    //      changes on other platforms or if setting up the watches failed.
+    class FileWatcher
+    {
+    public:
+        FileWatcher() = default;
+        
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher& operator=(const FileWatcher&) = delete;
+        
+        inline ~FileWatcher()
+        {
+            #if defined(__linux__)
+                if(InotifyFd >= 0)
+                    close(InotifyFd);
+            #endif
+        }
+        
+        inline static bool IsSupported()
+        {
+            #if defined(__linux__)
+                return true;
+            #else
+                return false;
+            #endif
+        }
+        
+        //NOTE: Replaces the watched paths of the group, the changes are reported with the group 
+        //      they are added in. Paths can be added to multiple groups.
+        //      The same inotify instance is kept, so the changes that are not waited yet are not 
+        //      discarded. Changes made while building are therefore still reported afterwards.
+        //      Directories are watched recursively, except hidden directories such as .runcpp2
+        inline bool SetWatchPaths(  const std::vector<ghc::filesystem::path>& filesPaths,
+                                    const std::vector<ghc::filesystem::path>& directoriesPaths,
+                                    int group = 0)
+        {
+            ssLOG_FUNC_DEBUG();
+            
+            #if defined(__linux__)
+                if(InotifyFd < 0)
+                {
+                    InotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+                    if(InotifyFd < 0)
+                    {
+                        ssLOG_WARNING("Failed to initialize inotify: " << strerror(errno));
+                        return false;
+                    }
+                }
+                
+                //Remove the group from the existing watches but only remove the watches that are 
+                //no longer needed afterwards, so that the pending events of the others are kept
+                for(auto it = Watches.begin(); it != Watches.end(); ++it)
+                {
+                    it->second.AllFilesGroups.erase(group);
+                    for(auto fileIt = it->second.FilesGroups.begin(); 
+                        fileIt != it->second.FilesGroups.end();)
+                    {
+                        fileIt->second.erase(group);
+                        if(fileIt->second.empty())
+                            fileIt = it->second.FilesGroups.erase(fileIt);
+                        else
+                            ++fileIt;
+                    }
+                }
+                
+                Groups.insert(group);
+                const bool added = AddWatchPaths(filesPaths, directoriesPaths, group);
+                RemoveUnusedWatches();
+                
+                ssLOG_DEBUG("Watching " << Watches.size() << " directories");
+                return added;
+            #else
+                (void)filesPaths;
+                (void)directoriesPaths;
+                (void)group;
+                return false;
+            #endif
+        }
+        
+        //NOTE: Blocks until any of the watched paths changes, and then waits until there are no
+        //      more changes for debounceMs so that a burst of writes only counts as one change.
+        //      Returns false if failed to wait for changes.
+        inline bool WaitForChanges(int debounceMs)
+        {
+            std::vector<int> changedGroups;
+            return WaitForChanges(debounceMs, changedGroups);
+        }
+        
+        //NOTE: Same as above, outChangedGroups are the groups of the paths that have changed
+        inline bool WaitForChanges(int debounceMs, std::vector<int>& outChangedGroups)
+        {
+            ssLOG_FUNC_DEBUG();
+            
+            outChangedGroups.clear();
+            #if defined(__linux__)
+                std::unordered_set<int> changedGroups;
+                if(!PollChanges(-1, debounceMs, changedGroups))
+                    return false;
+                
+                outChangedGroups.assign(changedGroups.begin(), changedGroups.end());
+                std::sort(outChangedGroups.begin(), outChangedGroups.end());
+                return true;
+            #else
+                (void)debounceMs;
+                return false;
+            #endif
+        }
+        
+        //NOTE: Same as WaitForChanges but returns straight away if there are no changes
+        inline bool CheckForChanges(int debounceMs, bool& outChanged)
+        {
+            outChanged = false;
+            #if defined(__linux__)
+                std::unordered_set<int> changedGroups;
+                if(!PollChanges(0, debounceMs, changedGroups))
+                    return false;
+                
+                outChanged = !changedGroups.empty();
+                return true;
+            #else
+                (void)debounceMs;
+                return false;
+            #endif
+        }
+    
+    private:
+        #if defined(__linux__)
+            struct WatchInfo
+            {
+                std::unordered_set<int> AllFilesGroups;
+                std::unordered_map<std::string, std::unordered_set<int>> FilesGroups;
+            };
+            
+            inline bool AddWatchPaths(  const std::vector<ghc::filesystem::path>& filesPaths,
+                                        const std::vector<ghc::filesystem::path>& directoriesPaths,
+                                        int group)
+            {
+                for(int i = 0; i < filesPaths.size(); ++i)
+                {
+                    int watchDescriptor = AddWatch(filesPaths.at(i).parent_path());
+                    if(watchDescriptor < 0)
+                        return false;
+                    
+                    const std::string fileName = filesPaths.at(i).filename().string();
+                    Watches[watchDescriptor].FilesGroups[fileName].insert(group);
+                }
+                
+                for(int i = 0; i < directoriesPaths.size(); ++i)
+                {
+                    std::error_code e;
+                    if(!ghc::filesystem::is_directory(directoriesPaths.at(i), e))
+                        continue;
+                    
+                    int watchDescriptor = AddWatch(directoriesPaths.at(i));
+                    if(watchDescriptor < 0)
+                        return false;
+                    Watches[watchDescriptor].AllFilesGroups.insert(group);
+                    
+                    ghc::filesystem::recursive_directory_iterator it(directoriesPaths.at(i), e);
+                    const ghc::filesystem::recursive_directory_iterator end;
+                    for(; !e && it != end; it.increment(e))
+                    {
+                        if(!it->is_directory(e))
+                            continue;
+                        
+                        if(it->path().filename().string().find('.') == 0)
+                        {
+                            it.disable_recursion_pending();
+                            continue;
+                        }
+                        
+                        watchDescriptor = AddWatch(it->path());
+                        if(watchDescriptor < 0)
+                            return false;
+                        Watches[watchDescriptor].AllFilesGroups.insert(group);
+                    }
+                }
+                
+                return true;
+            }
+            
+            inline void RemoveUnusedWatches()
+            {
+                for(auto it = Watches.begin(); it != Watches.end();)
+                {
+                    if(!it->second.AllFilesGroups.empty() || !it->second.FilesGroups.empty())
+                    {
+                        ++it;
+                        continue;
+                    }
+                    
+                    //The watch might be removed already if the directory is deleted
+                    inotify_rm_watch(InotifyFd, it->first);
+                    it = Watches.erase(it);
+                }
+            }
+            
+            inline int AddWatch(const ghc::filesystem::path& directory)
+            {
+                const uint32_t watchMask =  IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE |
+                                            IN_MOVED_FROM | IN_MOVED_TO;
+                
+                int watchDescriptor = inotify_add_watch(InotifyFd, 
+                                                        directory.string().c_str(), 
+                                                        watchMask);
+                if(watchDescriptor < 0)
+                {
+                    ssLOG_WARNING(  "Failed to watch " << directory.string() << ": " <<
+                                    strerror(errno));
+                }
+                return watchDescriptor;
+            }
+            
+            inline bool PollChanges(int timeoutMs, 
+                                    int debounceMs, 
+                                    std::unordered_set<int>& inOutChangedGroups)
+            {
+                if(InotifyFd < 0)
+                    return false;
+                
+                while(true)
+                {
+                    struct pollfd inotifyPoll = { InotifyFd, POLLIN, 0 };
+                    int pollResult = poll(  &inotifyPoll, 
+                                            1, 
+                                            inOutChangedGroups.empty() ? timeoutMs : debounceMs);
+                    if(pollResult < 0)
+                    {
+                        if(errno == EINTR)
+                            continue;
+                        
+                        ssLOG_WARNING("Failed to poll inotify: " << strerror(errno));
+                        return false;
+                    }
+                    
+                    //No more changes after debouncing, or no changes before timeout
+                    if(pollResult == 0)
+                        return true;
+                    
+                    if(!ReadEvents(inOutChangedGroups))
+                        return false;
+                }
+            }
+            
+            //NOTE: Adds the groups of the watched paths that the events are for
+            inline bool ReadEvents(std::unordered_set<int>& inOutChangedGroups)
+            {
+                alignas(struct inotify_event) char buffer[4096];
+                while(true)
+                {
+                    ssize_t bytesRead = read(InotifyFd, buffer, sizeof(buffer));
+                    if(bytesRead < 0)
+                    {
+                        if(errno == EINTR)
+                            continue;
+                        if(errno == EAGAIN)
+                            return true;
+                        
+                        ssLOG_WARNING("Failed to read inotify events: " << strerror(errno));
+                        return false;
+                    }
+                    
+                    for(ssize_t offset = 0; offset < bytesRead;)
+                    {
+                        const struct inotify_event* event =
+                            reinterpret_cast<const struct inotify_event*>(buffer + offset);
+                        offset += sizeof(struct inotify_event) + event->len;
+                        
+                        //We don't know what is dropped, assume it is what we are watching
+                        if(event->mask & IN_Q_OVERFLOW)
+                        {
+                            inOutChangedGroups.insert(Groups.begin(), Groups.end());
+                            continue;
+                        }
+                        
+                        if(Watches.count(event->wd) == 0)
+                            continue;
+                        
+                        const WatchInfo& watchInfo = Watches.at(event->wd);
+                        inOutChangedGroups.insert(  watchInfo.AllFilesGroups.begin(), 
+                                                    watchInfo.AllFilesGroups.end());
+                        
+                        if(event->len > 0 && watchInfo.FilesGroups.count(event->name) > 0)
+                        {
+                            const std::unordered_set<int>& fileGroups = 
+                                watchInfo.FilesGroups.at(event->name);
+                            inOutChangedGroups.insert(fileGroups.begin(), fileGroups.end());
+                        }
+                    }
+                }
+            }
+            
+            int InotifyFd = -1;
+            std::unordered_map<int, WatchInfo> Watches;
+            std::unordered_set<int> Groups;
+        #endif
+    };
+}
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef RUNCPP2_FILES_CACHE_HPP
+#define RUNCPP2_FILES_CACHE_HPP
+
+#if !defined(NOMINMAX)
+    #define NOMINMAX 1
+#endif
+
+#include "ghc/filesystem.hpp"
+
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+namespace runcpp2
+{
+    //NOTE: Information of the files used for building, shared between the scripts built in the
+    //      same process, such as when watching multiple scripts.
+    //      The write times of the source and include files are only checked once until
+    //      ClearWriteTimes() is called, which needs to be done whenever the files might have
+    //      changed.
+    //      The include records are kept and only used while the write times of the record files
+    //      stay the same.
+    class FilesCache
+    {
+    public:
+        //Returns false if the file doesn't exist
+        inline bool GetWriteTime(   const ghc::filesystem::path& path,
+                                    ghc::filesystem::file_time_type& outWriteTime)
+        {
+            const std::string key = path.string();
+            {
+                std::unique_lock<std::mutex> lock(CacheMutex);
+                auto it = WriteTimes.find(key);
+                if(it != WriteTimes.end())
+                {
+                    outWriteTime = it->second.WriteTime;
+                    return it->second.Exists;
+                }
+            }
+            
+            std::error_code e;
+            CachedWriteTime cachedWriteTime;
+            cachedWriteTime.WriteTime = ghc::filesystem::last_write_time(path, e);
+            cachedWriteTime.Exists = !e;
+            
+            std::unique_lock<std::mutex> lock(CacheMutex);
+            WriteTimes[key] = cachedWriteTime;
+            outWriteTime = cachedWriteTime.WriteTime;
+            return cachedWriteTime.Exists;
+        }
+        
+        inline void ClearWriteTimes()
+        {
+            std::unique_lock<std::mutex> lock(CacheMutex);
+            WriteTimes.clear();
+        }
+        
+        inline bool GetIncludeRecord(   const ghc::filesystem::path& recordPath,
+                                        std::vector<ghc::filesystem::path>& outIncludes,
+                                        ghc::filesystem::file_time_type& outRecordTime)
+        {
+            std::unique_lock<std::mutex> lock(CacheMutex);
+            auto it = IncludeRecords.find(recordPath.string());
+            if(it == IncludeRecords.end())
+                return false;
+            
+            outIncludes = it->second.Includes;
+            outRecordTime = it->second.RecordTime;
+            return true;
+        }
+        
+        inline void SetIncludeRecord(   const ghc::filesystem::path& recordPath,
+                                        const std::vector<ghc::filesystem::path>& includes,
+                                        const ghc::filesystem::file_time_type& recordTime)
+        {
+            std::unique_lock<std::mutex> lock(CacheMutex);
+            CachedIncludeRecord& record = IncludeRecords[recordPath.string()];
+            record.Includes = includes;
+            record.RecordTime = recordTime;
+        }
+        
+        inline void RemoveIncludeRecord(const ghc::filesystem::path& recordPath)
+        {
+            std::unique_lock<std::mutex> lock(CacheMutex);
+            IncludeRecords.erase(recordPath.string());
+        }
+    
+    private:
+        struct CachedWriteTime
+        {
+            ghc::filesystem::file_time_type WriteTime;
+            bool Exists = false;
+        };
+        
+        struct CachedIncludeRecord
+        {
+            std::vector<ghc::filesystem::path> Includes;
+            ghc::filesystem::file_time_type RecordTime;
+        };
+        
+        std::mutex CacheMutex;
+        std::unordered_map<std::string, CachedWriteTime> WriteTimes;
+        std::unordered_map<std::string, CachedIncludeRecord> IncludeRecords;
+    };
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef RUNCPP2_HASH_UTIL_HPP
+#define RUNCPP2_HASH_UTIL_HPP
+
+#include "ghc/filesystem.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+namespace runcpp2
+{
+    //NOTE: Minimal SHA-256 implementation (FIPS 180-4), used for verifying archive dependencies
+    class Sha256
+    {
+    public:
+        inline Sha256()
+        {
+            const uint32_t initialState[8] =
+            {
+                0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+            };
+            memcpy(State, initialState, sizeof(State));
+        }
+        
+        inline void Update(const unsigned char* data, std::size_t size)
+        {
+            for(std::size_t i = 0; i < size; ++i)
+            {
+                Block[BlockSize++] = data[i];
+                if(BlockSize == 64)
+                {
+                    ProcessBlock();
+                    TotalBits += 512;
+                    BlockSize = 0;
+                }
+            }
+        }
+        
+        //NOTE: Returns the digest as lowercase hex, no more updates can be done after this
+        inline std::string FinishHex()
+        {
+            const uint64_t totalBits = TotalBits + BlockSize * 8;
+            
+            //Padding is 0x80, zeros and then the message length in bits as big endian
+            const unsigned char paddingStart = 0x80;
+            Update(&paddingStart, 1);
+            
+            const unsigned char zero = 0;
+            while(BlockSize != 56)
+                Update(&zero, 1);
+            
+            unsigned char lengthBytes[8];
+            for(int i = 0; i < 8; ++i)
+                lengthBytes[i] = static_cast<unsigned char>(totalBits >> (56 - i * 8));
+            Update(lengthBytes, 8);
+            
+            const char* hexDigits = "0123456789abcdef";
+            std::string digest;
+            for(int i = 0; i < 8; ++i)
+            {
+                for(int j = 28; j >= 0; j -= 4)
+                    digest += hexDigits[(State[i] >> j) & 0xf];
+            }
+            
+            return digest;
+        }
+    
+    private:
+        inline static uint32_t RotateRight(uint32_t value, int bits)
+        {
+            return (value >> bits) | (value << (32 - bits));
+        }
+        
+        inline void ProcessBlock()
+        {
+            static const uint32_t roundConstants[64] =
+            {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+                0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+                0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+                0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+                0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+                0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+                0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+                0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+                0xc67178f2
+            };
+            
+            uint32_t words[64];
+            for(int i = 0; i < 16; ++i)
+            {
+                words[i] =  (static_cast<uint32_t>(Block[i * 4]) << 24) |
+                            (static_cast<uint32_t>(Block[i * 4 + 1]) << 16) |
+                            (static_cast<uint32_t>(Block[i * 4 + 2]) << 8) |
+                            static_cast<uint32_t>(Block[i * 4 + 3]);
+            }
+            
+            for(int i = 16; i < 64; ++i)
+            {
+                const uint32_t s0 = RotateRight(words[i - 15], 7) ^
+                                    RotateRight(words[i - 15], 18) ^
+                                    (words[i - 15] >> 3);
+                const uint32_t s1 = RotateRight(words[i - 2], 17) ^
+                                    RotateRight(words[i - 2], 19) ^
+                                    (words[i - 2] >> 10);
+                words[i] = words[i - 16] + s0 + words[i - 7] + s1;
+            }
+            
+            uint32_t a = State[0], b = State[1], c = State[2], d = State[3];
+            uint32_t e = State[4], f = State[5], g = State[6], h = State[7];
+            for(int i = 0; i < 64; ++i)
+            {
+                const uint32_t s1 = RotateRight(e, 6) ^ RotateRight(e, 11) ^ RotateRight(e, 25);
+                const uint32_t choice = (e & f) ^ (~e & g);
+                const uint32_t temp1 = h + s1 + choice + roundConstants[i] + words[i];
+                const uint32_t s0 = RotateRight(a, 2) ^ RotateRight(a, 13) ^ RotateRight(a, 22);
+                const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+                const uint32_t temp2 = s0 + majority;
+                
+                h = g;
+                g = f;
+                f = e;
+                e = d + temp1;
+                d = c;
+                c = b;
+                b = a;
+                a = temp1 + temp2;
+            }
+            
+            State[0] += a;
+            State[1] += b;
+            State[2] += c;
+            State[3] += d;
+            State[4] += e;
+            State[5] += f;
+            State[6] += g;
+            State[7] += h;
+        }
+        
+        uint32_t State[8];
+        unsigned char Block[64];
+        std::size_t BlockSize = 0;
+        uint64_t TotalBits = 0;
+    };
+    
+    inline bool GetFileSha256(const ghc::filesystem::path& filePath, std::string& outDigest)
+    {
+        std::ifstream file(filePath.string(), std::ios::binary);
+        if(!file.is_open())
+            return false;
+        
+        Sha256 hash;
+        char buffer[64 * 1024];
+        while(file)
+        {
+            file.read(buffer, sizeof(buffer));
+            hash.Update(reinterpret_cast<const unsigned char*>(buffer), file.gcount());
+        }
+        
+        if(file.bad())
+            return false;
+        
+        outDigest = hash.FinishHex();
+        return true;
+    }
+}
+
+#endif
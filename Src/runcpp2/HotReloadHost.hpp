@@ -0,0 +1,202 @@
+#ifndef RUNCPP2_HOT_RELOAD_HOST_HPP
+#define RUNCPP2_HOT_RELOAD_HOST_HPP
+
+#if !defined(NOMINMAX)
+    #define NOMINMAX 1
+#endif
+
+#include "ssLogger/ssLog.hpp"
+#include "ghc/filesystem.hpp"
+#include "DSResult/DSResult.hpp"
+#include "dylib.hpp"
+
+#include <exception>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace runcpp2
+{
+    //NOTE: Loads the script built as a shared library into runcpp2, and swaps it with the rebuilt
+    //      one when the sources change. The script needs to export the following functions:
+    //
+    //      extern "C" void* Runcpp2HotLoad(void* state, int argc, const char** argv)
+    //          Called after the library is loaded. state is nullptr for the first load, otherwise
+    //          it is the state returned by Runcpp2HotUnload. Returns the state of the script.
+    //          argv stays valid until runcpp2 exits, so it can be kept in the state.
+    //
+    //      extern "C" bool Runcpp2HotUpdate(void* state)
+    //          Called repeatedly, the library is only reloaded between the calls.
+    //          Returns false to stop running.
+    //
+    //      extern "C" void* Runcpp2HotUnload(void* state, bool reloading) (Optional)
+    //          Called before the library is unloaded. Returns the state to be passed to the next
+    //          Runcpp2HotLoad if reloading.
+    //
+    //      The library is copied before loading, so that it can be relinked while it is loaded.
+    class HotReloadHost
+    {
+    public:
+        using LoadFunction = void*(void*, int, const char**);
+        using UpdateFunction = bool(void*);
+        using UnloadFunction = void*(void*, bool);
+        
+        HotReloadHost() = default;
+        
+        HotReloadHost(const HotReloadHost&) = delete;
+        HotReloadHost& operator=(const HotReloadHost&) = delete;
+        
+        inline ~HotReloadHost()
+        {
+            if(IsLoaded())
+                Unload(false);
+        }
+        
+        inline bool IsLoaded() const
+        {
+            return Library != nullptr;
+        }
+        
+        //NOTE: Unloads the current library if there's any after the new one is loaded, and passes
+        //      its state to the new one
+        inline DS::Result<void> Load(   const ghc::filesystem::path& libraryPath,
+                                        const std::vector<std::string>& runArgs)
+        {
+            ssLOG_FUNC_INFO();
+            
+            std::error_code e;
+            if(libraryPath.empty() || !ghc::filesystem::exists(libraryPath, e))
+            {
+                return DS_ERROR_MSG("Failed to find the shared library to load: " +
+                                    libraryPath.string());
+            }
+            
+            const ghc::filesystem::path copyDirectory = libraryPath.parent_path() / "HotReload";
+            if(!ghc::filesystem::exists(copyDirectory, e))
+            {
+                if(!ghc::filesystem::create_directories(copyDirectory, e))
+                    return DS_ERROR_MSG("Failed to create directory: " + copyDirectory.string());
+            }
+            
+            const ghc::filesystem::path copyPath =
+                copyDirectory /
+                (
+                    libraryPath.stem().string() + "_" + std::to_string(LoadCount) +
+                    libraryPath.extension().string()
+                );
+            
+            ghc::filesystem::copy_file( libraryPath,
+                                        copyPath,
+                                        ghc::filesystem::copy_options::overwrite_existing,
+                                        e);
+            if(e)
+            {
+                return DS_ERROR_MSG("Failed to copy " + libraryPath.string() + " to " +
+                                    copyPath.string() + ": " + e.message());
+            }
+            
+            std::unique_ptr<dylib> newLibrary;
+            LoadFunction* newLoadFunction = nullptr;
+            UpdateFunction* newUpdateFunction = nullptr;
+            UnloadFunction* newUnloadFunction = nullptr;
+            try
+            {
+                newLibrary.reset(new dylib( copyPath.parent_path().string(),
+                                            copyPath.filename().string(),
+                                            dylib::no_filename_decorations));
+                
+                newLoadFunction = newLibrary->get_function<LoadFunction>("Runcpp2HotLoad");
+                newUpdateFunction = newLibrary->get_function<UpdateFunction>("Runcpp2HotUpdate");
+                if(newLibrary->has_symbol("Runcpp2HotUnload"))
+                {
+                    newUnloadFunction =
+                        newLibrary->get_function<UnloadFunction>("Runcpp2HotUnload");
+                }
+            }
+            catch(std::exception& ex)
+            {
+                ghc::filesystem::remove(copyPath, e);
+                return DS_ERROR_MSG("Failed to load " + libraryPath.string() + ": " + ex.what());
+            }
+            
+            //Only unload the current library once the new one is ready
+            if(IsLoaded())
+                Unload(true);
+            
+            Library = std::move(newLibrary);
+            LoadedCopyPath = copyPath;
+            LoadHook = newLoadFunction;
+            UpdateHook = newUpdateFunction;
+            UnloadHook = newUnloadFunction;
+            ++LoadCount;
+            
+            //NOTE: The arguments are only set on the first load and kept afterwards, since the 
+            //      state passed between the loads can still be referring to them
+            if(Arguments.empty())
+            {
+                Arguments.push_back(libraryPath.string());
+                Arguments.insert(Arguments.end(), runArgs.begin(), runArgs.end());
+                for(int i = 0; i < Arguments.size(); ++i)
+                    ArgumentsPointers.push_back(Arguments.at(i).c_str());
+                ArgumentsPointers.push_back(nullptr);
+            }
+            
+            ssLOG_INFO("Loaded " << LoadedCopyPath.string());
+            State = LoadHook(   State, 
+                                static_cast<int>(Arguments.size()), 
+                                ArgumentsPointers.data());
+            return {};
+        }
+        
+        //NOTE: Returns false if the script wants to stop running
+        inline bool RunUpdate()
+        {
+            if(!IsLoaded())
+                return false;
+            
+            return UpdateHook(State);
+        }
+        
+        inline void Unload(bool reloading)
+        {
+            ssLOG_FUNC_INFO();
+            
+            if(!IsLoaded())
+                return;
+            
+            if(UnloadHook)
+                State = UnloadHook(State, reloading);
+            
+            if(!reloading)
+                State = nullptr;
+            
+            Library.reset();
+            LoadHook = nullptr;
+            UpdateHook = nullptr;
+            UnloadHook = nullptr;
+            
+            std::error_code e;
+            ghc::filesystem::remove(LoadedCopyPath, e);
+            if(e)
+            {
+                ssLOG_WARNING(  "Failed to remove " << LoadedCopyPath.string() << ": " << 
+                                e.message());
+            }
+            LoadedCopyPath.clear();
+        }
+    
+    private:
+        std::unique_ptr<dylib> Library;
+        ghc::filesystem::path LoadedCopyPath;
+        LoadFunction* LoadHook = nullptr;
+        UpdateFunction* UpdateHook = nullptr;
+        UnloadFunction* UnloadHook = nullptr;
+        void* State = nullptr;
+        int LoadCount = 0;
+        std::vector<std::string> Arguments;
+        std::vector<const char*> ArgumentsPointers;
+    };
+}
+
+#endif
@@ -2,6 +2,7 @@
 #define RUNCPP2_INCLUDE_MANAGER_HPP
 
 #include "runcpp2/Data/ParseCommon.hpp"
+#include "runcpp2/FilesCache.hpp"
 
 #if !defined(NOMINMAX)
     #define NOMINMAX 1
@@ -16,6 +17,7 @@
 #include <cstddef>
 #include <string>
 #include <system_error>
+#include <unordered_map>
 
 #if defined(INTERNAL_RUNCPP2_UNIT_TESTS) && \
     INTERNAL_RUNCPP2_UNIT_TESTS == INTERNAL_RUNCPP2_UNIT_TESTS_INCLUDE_MANAGER
@@ -29,6 +31,9 @@
 
 namespace runcpp2
 {
+    //Paths for each source file, such as the files it includes
+    using SourceIncludeMap = std::unordered_map<std::string, std::vector<ghc::filesystem::path>>;
+    
     class IncludeManager
     {
     public:
@@ -56,6 +61,26 @@ namespace runcpp2
             INTERNAL_RUNCPP2_SAFE_CATCH_RETURN(false);
         }
         
+        //NOTE: If set, the include records and the write times of the files are taken from the 
+        //      cache instead of the filesystem.
+        inline void SetFilesCache(FilesCache* filesCache)
+        {
+            Cache = filesCache;
+        }
+        
+        inline ghc::filesystem::file_time_type GetWriteTime(const ghc::filesystem::path& path) const
+        {
+            ghc::filesystem::file_time_type writeTime;
+            if(Cache != nullptr)
+                Cache->GetWriteTime(path, writeTime);
+            else
+            {
+                std::error_code e;
+                writeTime = ghc::filesystem::last_write_time(path, e);
+            }
+            return writeTime;
+        }
+        
         inline bool WriteIncludeRecord( const ghc::filesystem::path& sourceFile,
                                         const std::vector<ghc::filesystem::path>& includes)
         {
@@ -69,6 +94,8 @@ namespace runcpp2
             }
             
             ghc::filesystem::path recordPath = GetRecordPath(sourceFile);
+            if(Cache != nullptr)
+                Cache->RemoveIncludeRecord(recordPath);
             
             std::ofstream recordFile(recordPath);
             if(!recordFile.is_open())
@@ -100,6 +127,17 @@ namespace runcpp2
             
             outIncludes.clear();
             ghc::filesystem::path recordPath = GetRecordPath(sourceFile);
+            if(Cache != nullptr)
+            {
+                ghc::filesystem::file_time_type recordTime;
+                if( Cache->GetWriteTime(recordPath, recordTime) &&
+                    Cache->GetIncludeRecord(recordPath, outIncludes, outRecordTime) &&
+                    outRecordTime == recordTime)
+                {
+                    return true;
+                }
+                outIncludes.clear();
+            }
             
             std::error_code e;
             if(!ghc::filesystem::exists(recordPath, e))
@@ -121,6 +159,9 @@ namespace runcpp2
                     outIncludes.push_back(ghc::filesystem::path(line));
             }
             
+            if(Cache != nullptr)
+                Cache->SetIncludeRecord(recordPath, outIncludes, outRecordTime);
+            
             return true;
             INTERNAL_RUNCPP2_SAFE_CATCH_RETURN(false);
         }
@@ -135,7 +176,7 @@ namespace runcpp2
             ssLOG_DEBUG("Checking includes for " << sourceFile.string());
             
             std::error_code e;
-            ghc::filesystem::file_time_type sourceTime = ghc::filesystem::last_write_time(sourceFile, e);
+            ghc::filesystem::file_time_type sourceTime = GetWriteTime(sourceFile);
             
             ssLOG_DEBUG("sourceTime: " << sourceTime.time_since_epoch().count());
             ssLOG_DEBUG("recordTime: " << recordTime.time_since_epoch().count());
@@ -148,15 +189,23 @@ namespace runcpp2
             
             for(const ghc::filesystem::path& include : includes)
             {
-                if(!ghc::filesystem::exists(include, e))
+                ghc::filesystem::file_time_type includeTime;
+                bool includeExists = false;
+                if(Cache != nullptr)
+                    includeExists = Cache->GetWriteTime(include, includeTime);
+                else
+                {
+                    includeExists = ghc::filesystem::exists(include, e);
+                    if(includeExists)
+                        includeTime = ghc::filesystem::last_write_time(include, e);
+                }
+                
+                if(!includeExists)
                 {
                     ssLOG_DEBUG("Include file does not exist: " << include.string());
                     return true;
                 }
                 
-                ghc::filesystem::file_time_type includeTime = 
-                    ghc::filesystem::last_write_time(include, e);
-                
                 if(includeTime > recordTime)
                 {
                     ssLOG_DEBUG("Include time for " << include.string() << 
@@ -188,6 +237,7 @@ namespace runcpp2
         }
         
         ghc::filesystem::path IncludeRecordDir;
+        FilesCache* Cache = nullptr;
     };
 }
 
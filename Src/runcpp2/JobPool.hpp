@@ -0,0 +1,252 @@
+#ifndef RUNCPP2_JOB_POOL_HPP
+#define RUNCPP2_JOB_POOL_HPP
+
+#include "runcpp2/Jobserver.hpp"
+
+#include "ssLogger/ssLog.hpp"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace runcpp2
+{
+    //NOTE: A fixed set of worker threads taking jobs from a shared queue.
+    //      A worker picks up the next job as soon as it finishes the current one,
+    //      so a slow job doesn't hold back the rest of the queue.
+    //      If a memory limit is set, a job only starts when the estimated memory of it and the
+    //      running jobs stays under the limit. A job can always start if nothing else is running.
+    //      If a jobserver is given, a job also needs a token from it to start.
+    //      Each running job takes up one of the slots in the pool. Work that is not run by the 
+    //      workers, such as commands finishing on the subprocess waiting thread, can take a slot 
+    //      with AcquireSlot() as well so that it is counted towards the same limits.
+    class JobPool
+    {
+    public:
+        struct Slot
+        {
+            int64_t EstimatedMemoryKB = 0;
+            bool ImplicitToken = true;
+            char Token = '+';
+        };
+        
+        inline JobPool( int maxThreads, 
+                        int64_t memoryLimitKB = 0, 
+                        Jobserver* jobserver = nullptr) : 
+            MaxThreads(maxThreads < 1 ? 1 : maxThreads),
+            MemoryLimitKB(memoryLimitKB < 0 ? 0 : memoryLimitKB),
+            JobserverPtr(jobserver)
+        {
+            //Cache logs for worker threads
+            ssLOG_ENABLE_CACHE_OUTPUT_FOR_NEW_THREADS();
+            int logLevel = ssLOG_GET_CURRENT_THREAD_TARGET_LEVEL();
+            
+            for(int i = 0; i < MaxThreads; ++i)
+                Workers.emplace_back([this, logLevel]() { WorkerLoop(logLevel); });
+        }
+        
+        JobPool(const JobPool&) = delete;
+        JobPool& operator=(const JobPool&) = delete;
+        
+        inline ~JobPool()
+        {
+            {
+                std::unique_lock<std::mutex> lock(QueueMutex);
+                Stopping = true;
+            }
+            
+            QueueCondition.notify_all();
+            for(int i = 0; i < Workers.size(); ++i)
+            {
+                if(Workers.at(i).joinable())
+                    Workers.at(i).join();
+            }
+        }
+        
+        template<typename T>
+        inline std::future<T> AddJob(std::function<T()> job, int64_t estimatedMemoryKB = 0)
+        {
+            std::shared_ptr<std::packaged_task<T()>> task =
+                std::make_shared<std::packaged_task<T()>>(job);
+            
+            std::future<T> result = task->get_future();
+            {
+                std::unique_lock<std::mutex> lock(QueueMutex);
+                QueuedJob queuedJob;
+                queuedJob.Job = [task]() { (*task)(); };
+                queuedJob.EstimatedMemoryKB = estimatedMemoryKB < 0 ? 0 : estimatedMemoryKB;
+                Jobs.push_back(queuedJob);
+            }
+            
+            QueueCondition.notify_one();
+            return result;
+        }
+        
+        //NOTE: Blocks until a slot is available. The slot must be released with ReleaseSlot() 
+        //      once the work is finished.
+        inline Slot AcquireSlot(int64_t estimatedMemoryKB = 0)
+        {
+            Slot slot;
+            slot.EstimatedMemoryKB = estimatedMemoryKB < 0 ? 0 : estimatedMemoryKB;
+            {
+                std::unique_lock<std::mutex> lock(QueueMutex);
+                QueueCondition.wait
+                (
+                    lock, 
+                    [this, &slot]() { return CanStart(slot.EstimatedMemoryKB); }
+                );
+                
+                RunningMemoryKB += slot.EstimatedMemoryKB;
+                ++RunningJobsCount;
+            }
+            
+            //Get the token outside the lock since it blocks until one is available
+            if(JobserverPtr)
+                JobserverPtr->AcquireToken(slot.ImplicitToken, slot.Token);
+            
+            return slot;
+        }
+        
+        inline void ReleaseSlot(const Slot& slot)
+        {
+            if(JobserverPtr)
+                JobserverPtr->ReleaseToken(slot.ImplicitToken, slot.Token);
+            
+            {
+                std::unique_lock<std::mutex> lock(QueueMutex);
+                RunningMemoryKB -= slot.EstimatedMemoryKB;
+                --RunningJobsCount;
+            }
+            
+            QueueCondition.notify_all();
+        }
+        
+        inline int GetMaxThreads() const
+        {
+            return MaxThreads;
+        }
+        
+        inline const Jobserver* GetJobserver() const
+        {
+            return JobserverPtr;
+        }
+        
+        inline int64_t GetMemoryLimitKB() const
+        {
+            return MemoryLimitKB;
+        }
+    
+    private:
+        struct QueuedJob
+        {
+            std::function<void()> Job;
+            int64_t EstimatedMemoryKB = 0;
+        };
+        
+        //NOTE: Must be called with QueueMutex locked
+        inline bool CanStart(int64_t estimatedMemoryKB) const
+        {
+            if(RunningJobsCount >= MaxThreads)
+                return false;
+            
+            return  MemoryLimitKB == 0 || 
+                    RunningJobsCount == 0 || 
+                    RunningMemoryKB + estimatedMemoryKB <= MemoryLimitKB;
+        }
+        
+        //NOTE: Must be called with QueueMutex locked. Returns -1 if no job can be started now.
+        inline int GetNextJobIndex() const
+        {
+            for(int i = 0; i < Jobs.size(); ++i)
+            {
+                if(CanStart(Jobs.at(i).EstimatedMemoryKB))
+                    return i;
+            }
+            
+            return -1;
+        }
+        
+        inline void WorkerLoop(int logLevel)
+        {
+            ssLOG_SET_CURRENT_THREAD_TARGET_LEVEL(logLevel);
+            
+            while(true)
+            {
+                QueuedJob queuedJob;
+                {
+                    std::unique_lock<std::mutex> lock(QueueMutex);
+                    QueueCondition.wait
+                    (
+                        lock, 
+                        [this]() 
+                        { 
+                            return (Stopping && Jobs.empty()) || GetNextJobIndex() >= 0; 
+                        }
+                    );
+                    
+                    //Finish the remaining jobs before stopping
+                    if(GetNextJobIndex() < 0)
+                        return;
+                }
+                
+                //Get the token outside the lock since it blocks until one is available
+                bool implicitToken = true;
+                char token = '+';
+                if(JobserverPtr)
+                    JobserverPtr->AcquireToken(implicitToken, token);
+                
+                {
+                    std::unique_lock<std::mutex> lock(QueueMutex);
+                    
+                    //Other workers might have taken the job while we were getting the token
+                    int jobIndex = GetNextJobIndex();
+                    if(jobIndex < 0)
+                    {
+                        lock.unlock();
+                        if(JobserverPtr)
+                            JobserverPtr->ReleaseToken(implicitToken, token);
+                        continue;
+                    }
+                    
+                    queuedJob = std::move(Jobs.at(jobIndex));
+                    Jobs.erase(Jobs.begin() + jobIndex);
+                    RunningMemoryKB += queuedJob.EstimatedMemoryKB;
+                    ++RunningJobsCount;
+                }
+                
+                queuedJob.Job();
+                
+                if(JobserverPtr)
+                    JobserverPtr->ReleaseToken(implicitToken, token);
+                
+                {
+                    std::unique_lock<std::mutex> lock(QueueMutex);
+                    RunningMemoryKB -= queuedJob.EstimatedMemoryKB;
+                    --RunningJobsCount;
+                }
+                
+                //Waiting jobs and slots might fit into the freed slot now
+                QueueCondition.notify_all();
+            }
+        }
+        
+        const int MaxThreads;
+        const int64_t MemoryLimitKB;
+        Jobserver* JobserverPtr;
+        std::vector<std::thread> Workers;
+        std::deque<QueuedJob> Jobs;
+        int64_t RunningMemoryKB = 0;
+        int RunningJobsCount = 0;
+        std::mutex QueueMutex;
+        std::condition_variable QueueCondition;
+        bool Stopping = false;
+    };
+}
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef RUNCPP2_JOBSERVER_HPP
+#define RUNCPP2_JOBSERVER_HPP
+
+#include "ssLogger/ssLog.hpp"
+
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <unistd.h>
+#endif
+
+namespace runcpp2
+{
+    //NOTE: GNU make jobserver shared between the compilations and the dependencies build commands.
+    //      If runcpp2 is running under a jobserver (MAKEFLAGS), it uses that one as a client.
+    //      Otherwise it creates one with the number of jobs, which is passed down to the commands
+    //      that are given GetMakeFlags() and GetFds() (see SubprocessManager::Start), so make 
+    //      (and other tools supporting it) running in the build commands share the tokens.
+    //      The pipe is close-on-exec so that other commands don't inherit it. The commands using
+    //      it get the pipe duplicated onto other file descriptors reserved for them, since
+    //      duplicating onto the same file descriptor doesn't clear close-on-exec before glibc 2.29.
+    //      Each process owns one implicit token, and needs to take one from the jobserver for
+    //      each additional job. Only supported on POSIX, does nothing on other platforms.
+    class Jobserver
+    {
+    public:
+        Jobserver() = default;
+        
+        Jobserver(const Jobserver&) = delete;
+        Jobserver& operator=(const Jobserver&) = delete;
+        
+        inline ~Jobserver()
+        {
+            #if !defined(_WIN32)
+                if(!IsServer)
+                {
+                    if(OpenedFifo)
+                        close(ReadFd);
+                    return;
+                }
+                
+                close(ReadFd);
+                close(WriteFd);
+                if(CommandReadFd >= 0)
+                    close(CommandReadFd);
+                if(CommandWriteFd >= 0)
+                    close(CommandWriteFd);
+            #endif
+        }
+        
+        inline bool Initialize(int maxThreads)
+        {
+            ssLOG_FUNC_DEBUG();
+            
+            #if defined(_WIN32)
+                (void)maxThreads;
+                return false;
+            #else
+                if(Enabled)
+                    return true;
+                
+                const char* makeFlags = getenv("MAKEFLAGS");
+                if(makeFlags && ConnectToServer(makeFlags))
+                {
+                    ssLOG_INFO("Using jobserver from MAKEFLAGS");
+                    Enabled = true;
+                    return true;
+                }
+                
+                int fds[2];
+                #if defined(__linux__)
+                    const bool pipeCreated = pipe2(fds, O_CLOEXEC) == 0;
+                #else
+                    const bool pipeCreated =    pipe(fds) == 0 && 
+                                                fcntl(fds[0], F_SETFD, FD_CLOEXEC) == 0 &&
+                                                fcntl(fds[1], F_SETFD, FD_CLOEXEC) == 0;
+                #endif
+                if(!pipeCreated)
+                {
+                    ssLOG_WARNING("Failed to create jobserver pipe: " << strerror(errno));
+                    return false;
+                }
+                
+                //NOTE: The file descriptors for the commands are only kept open so that their 
+                //      numbers are not used by anything else. They are close-on-exec as well, 
+                //      and replaced by the pipe in the commands using the jobserver.
+                const int commandFds[2] = 
+                {
+                    fcntl(fds[0], F_DUPFD_CLOEXEC, 3),
+                    fcntl(fds[1], F_DUPFD_CLOEXEC, 3)
+                };
+                if(commandFds[0] < 0 || commandFds[1] < 0)
+                {
+                    ssLOG_WARNING("Failed to reserve jobserver file descriptors: " << 
+                                  strerror(errno));
+                    for(int i = 0; i < 2; ++i)
+                    {
+                        close(fds[i]);
+                        if(commandFds[i] >= 0)
+                            close(commandFds[i]);
+                    }
+                    return false;
+                }
+                
+                ReadFd = fds[0];
+                WriteFd = fds[1];
+                CommandReadFd = commandFds[0];
+                CommandWriteFd = commandFds[1];
+                IsServer = true;
+                
+                //We have the implicit token already
+                for(int i = 0; i < maxThreads - 1; ++i)
+                {
+                    if(write(WriteFd, "+", 1) != 1)
+                    {
+                        ssLOG_WARNING("Failed to add token to jobserver: " << strerror(errno));
+                        break;
+                    }
+                }
+                
+                const std::string previousMakeFlags = makeFlags ? makeFlags : "";
+                MakeFlags = previousMakeFlags +
+                            (previousMakeFlags.empty() ? "" : " ") +
+                            "-j" + std::to_string(maxThreads) +
+                            " --jobserver-auth=" +
+                            std::to_string(CommandReadFd) + "," +
+                            std::to_string(CommandWriteFd);
+                ssLOG_DEBUG("MAKEFLAGS: " << MakeFlags);
+                
+                Enabled = true;
+                return true;
+            #endif
+        }
+        
+        inline bool IsEnabled() const
+        {
+            return Enabled;
+        }
+        
+        //NOTE: The MAKEFLAGS the commands using the jobserver need, or empty if they can use the
+        //      one runcpp2 is running with
+        inline const std::string& GetMakeFlags() const
+        {
+            return MakeFlags;
+        }
+        
+        //NOTE: The file descriptors the commands using the jobserver need to inherit, paired with 
+        //      the ones they are duplicated onto in the commands (the ones in GetMakeFlags()).
+        //      Empty if the commands inherit them already.
+        inline std::vector<std::pair<int, int>> GetFds() const
+        {
+            if(!IsServer)
+                return {};
+            
+            return 
+            { 
+                std::make_pair(ReadFd, CommandReadFd), 
+                std::make_pair(WriteFd, CommandWriteFd) 
+            };
+        }
+        
+        //NOTE: Blocks until a token is available. The token must be released after the job.
+        inline void AcquireToken(bool& outImplicit, char& outToken)
+        {
+            outImplicit = true;
+            outToken = '+';
+            if(!Enabled)
+                return;
+            
+            #if !defined(_WIN32)
+                while(true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(TokenMutex);
+                        if(!ImplicitTokenUsed)
+                        {
+                            ImplicitTokenUsed = true;
+                            return;
+                        }
+                    }
+                    
+                    //Check the implicit token again from time to time, since it can be released
+                    //while we are waiting for the jobserver
+                    struct pollfd readPoll = { ReadFd, POLLIN, 0 };
+                    int pollResult = poll(&readPoll, 1, 100);
+                    if(pollResult <= 0 || !(readPoll.revents & POLLIN))
+                        continue;
+                    
+                    //NOTE: Another process might have taken the token after polling, in which case
+                    //      this blocks until a token is given back
+                    char token;
+                    if(read(ReadFd, &token, 1) == 1)
+                    {
+                        outImplicit = false;
+                        outToken = token;
+                        return;
+                    }
+                }
+            #endif
+        }
+        
+        inline void ReleaseToken(bool implicit, char token)
+        {
+            if(!Enabled)
+                return;
+            
+            #if !defined(_WIN32)
+                if(implicit)
+                {
+                    std::unique_lock<std::mutex> lock(TokenMutex);
+                    ImplicitTokenUsed = false;
+                    return;
+                }
+                
+                while(write(WriteFd, &token, 1) != 1)
+                {
+                    if(errno != EINTR)
+                    {
+                        ssLOG_ERROR("Failed to give token back to jobserver: " << strerror(errno));
+                        return;
+                    }
+                }
+            #else
+                (void)implicit;
+                (void)token;
+            #endif
+        }
+    
+    private:
+        #if !defined(_WIN32)
+            //NOTE: Supports "--jobserver-auth=R,W", "--jobserver-fds=R,W" and
+            //      "--jobserver-auth=fifo:PATH"
+            inline bool ConnectToServer(const std::string& makeFlags)
+            {
+                std::size_t authIndex = makeFlags.rfind("--jobserver-auth=");
+                std::size_t authLength = std::string("--jobserver-auth=").size();
+                if(authIndex == std::string::npos)
+                {
+                    authIndex = makeFlags.rfind("--jobserver-fds=");
+                    authLength = std::string("--jobserver-fds=").size();
+                }
+                
+                if(authIndex == std::string::npos)
+                    return false;
+                
+                std::size_t authEnd = makeFlags.find(' ', authIndex);
+                std::string auth = makeFlags.substr(authIndex + authLength,
+                                                    authEnd == std::string::npos ?
+                                                    std::string::npos :
+                                                    authEnd - authIndex - authLength);
+                
+                if(auth.find("fifo:") == 0)
+                {
+                    std::string fifoPath = auth.substr(std::string("fifo:").size());
+                    int fifoFd = open(fifoPath.c_str(), O_RDWR | O_CLOEXEC);
+                    if(fifoFd < 0)
+                    {
+                        ssLOG_WARNING("Failed to open jobserver fifo " << fifoPath << ": " <<
+                                      strerror(errno));
+                        return false;
+                    }
+                    
+                    ReadFd = fifoFd;
+                    WriteFd = fifoFd;
+                    OpenedFifo = true;
+                    return true;
+                }
+                
+                std::size_t commaIndex = auth.find(',');
+                if(commaIndex == std::string::npos)
+                    return false;
+                
+                int readFd = strtol(auth.substr(0, commaIndex).c_str(), nullptr, 10);
+                int writeFd = strtol(auth.substr(commaIndex + 1).c_str(), nullptr, 10);
+                
+                //The file descriptors are not passed down to us
+                if( readFd < 0 || 
+                    writeFd < 0 || 
+                    fcntl(readFd, F_GETFD) < 0 || 
+                    fcntl(writeFd, F_GETFD) < 0)
+                {
+                    ssLOG_WARNING("Jobserver in MAKEFLAGS is not available to runcpp2");
+                    return false;
+                }
+                
+                ReadFd = readFd;
+                WriteFd = writeFd;
+                return true;
+            }
+        #endif
+        
+        bool Enabled = false;
+        bool IsServer = false;
+        bool OpenedFifo = false;
+        std::string MakeFlags;
+        int ReadFd = -1;
+        int WriteFd = -1;
+        int CommandReadFd = -1;
+        int CommandWriteFd = -1;
+        std::mutex TokenMutex;
+        bool ImplicitTokenUsed = false;
+    };
+}
+
+#endif
@@ -386,6 +386,39 @@ namespace runcpp2
         outIncludePath = line.substr(start, end - start);
         return true;
     }
+    
+    //NOTE: Returns false if the line is an include that ParseIncludes can't resolve to a file 
+    //      the same way as the compiler, such as "# include", macro includes, #include_next, 
+    //      #import or __has_include
+    inline bool IsIncludeResolvable(const std::string& line)
+    {
+        if(line.find("__has_include") != std::string::npos)
+            return false;
+        
+        size_t hashPos = line.find_first_not_of(" \t");
+        if(hashPos == std::string::npos || line[hashPos] != '#')
+            return true;
+        
+        size_t directiveStart = line.find_first_not_of(" \t", hashPos + 1);
+        if(directiveStart == std::string::npos)
+            return true;
+        
+        size_t directiveEnd = line.find_first_not_of(  "abcdefghijklmnopqrstuvwxyz_", 
+                                                        directiveStart);
+        std::string directive = line.substr(directiveStart, 
+                                            directiveEnd == std::string::npos ? 
+                                            std::string::npos : 
+                                            directiveEnd - directiveStart);
+        
+        if(directive == "include_next" || directive == "import")
+            return false;
+        
+        if(directive != "include")
+            return true;
+        
+        std::string includePath;
+        return directiveStart == hashPos + 1 && ParseIncludes(line, includePath);
+    }
 
     template<typename T>
     bool ParsePlatformProfileMap(   YAML::ConstNodePtr node, 
@@ -15,6 +15,7 @@
 
 #include "runcpp2/BuildsManager.hpp"
 #include "runcpp2/IncludeManager.hpp"
+#include "runcpp2/JobPool.hpp"
 
 #include "runcpp2/ConfigParsing.hpp"
 #include "runcpp2/DependenciesHelper.hpp"
@@ -34,7 +35,10 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
 #include <queue>
+#include <algorithm>
 #include <stddef.h>
 #include <exception>
 #include <fstream>
@@ -92,6 +96,8 @@ namespace
 
 namespace runcpp2
 {
+    //NOTE: Files are only copied if they have changed, which is when the size or the write time is 
+    //      different. They are hardlinked if possible, otherwise copied with the write time kept.
     inline DS::Result<void> CopyFiles(  const ghc::filesystem::path& destDir,
                                         const std::vector<ghc::filesystem::path>& filePaths,
                                         std::vector<std::string>& outCopiedPaths)
@@ -102,26 +108,66 @@ namespace runcpp2
         for (const ghc::filesystem::path& srcPath : filePaths)
         {
             ghc::filesystem::path destPath = destDir / srcPath.filename();
-
-            if(ghc::filesystem::exists(srcPath, e))
+            
+            if(!ghc::filesystem::exists(srcPath, e))
+                return DS_ERROR_MSG("File to copy not found: " + srcPath.string());
+            
+            if(ghc::filesystem::exists(destPath, e))
             {
-                ghc::filesystem::copy(srcPath, 
-                                      destPath, 
-                                      ghc::filesystem::copy_options::update_existing, 
-                                      e);
-                if(e)
+                //Skip if it is the same file (i.e. hardlinked) or has the same size and write time
+                bool upToDate = ghc::filesystem::equivalent(srcPath, destPath, e);
+                if(!upToDate)
+                {
+                    upToDate =  ghc::filesystem::file_size(srcPath, e) == 
+                                    ghc::filesystem::file_size(destPath, e) &&
+                                ghc::filesystem::last_write_time(srcPath, e) == 
+                                    ghc::filesystem::last_write_time(destPath, e);
+                }
+                
+                if(upToDate && !e)
                 {
-                    std::string errorMsg = DS_STR(  "Failed to copy file from ") + srcPath.string() + 
-                                                    " to " + destPath.string() + "\nError: " + 
-                                                    e.message();
-                    return DS_ERROR_MSG(errorMsg);
+                    ssLOG_DEBUG(destPath.string() << " is up to date");
+                    outCopiedPaths.push_back(ProcessPath(destPath));
+                    continue;
                 }
                 
-                ssLOG_INFO("Copied from " << srcPath.string() << " to " << destPath.string());
-                outCopiedPaths.push_back(ProcessPath(destPath));
+                //Remove it instead of overwriting it because it could be a hardlink to an older 
+                //version of the file, which would be modified as well
+                e.clear();
+                ghc::filesystem::remove(destPath, e);
             }
-            else
-                return DS_ERROR_MSG("File to copy not found: " + srcPath.string());
+            
+            if(!e)
+            {
+                //Hardlink the actual file in case the source is a symlink
+                ghc::filesystem::path linkSrcPath = ghc::filesystem::canonical(srcPath, e);
+                if(!e)
+                    ghc::filesystem::create_hard_link(linkSrcPath, destPath, e);
+                
+                if(e)
+                {
+                    ssLOG_DEBUG("Hardlink failed: " << e.message());
+                    CloneOrCopyFile(srcPath, destPath, e);
+                    
+                    //Keep the write time so that the copy is up to date for the next run
+                    ghc::filesystem::file_time_type srcWriteTime;
+                    if(!e)
+                        srcWriteTime = ghc::filesystem::last_write_time(srcPath, e);
+                    if(!e)
+                        ghc::filesystem::last_write_time(destPath, srcWriteTime, e);
+                }
+            }
+            
+            if(e)
+            {
+                std::string errorMsg = DS_STR(  "Failed to copy file from ") + srcPath.string() + 
+                                                " to " + destPath.string() + "\nError: " + 
+                                                e.message();
+                return DS_ERROR_MSG(errorMsg);
+            }
+            
+            ssLOG_INFO("Copied from " << srcPath.string() << " to " << destPath.string());
+            outCopiedPaths.push_back(ProcessPath(destPath));
         }
         
         return {};
@@ -432,6 +478,11 @@ namespace runcpp2
                                         currentLinkFlags != nullptr && 
                                         !lastLinkFlags->Equals(*currentLinkFlags)
                                     );
+                
+                //Relink if shared dependencies are switched between being copied and using rpath
+                outRelinkNeeded =   outRelinkNeeded || 
+                                    lastInfo->SharedDependenciesRPath != 
+                                        scriptInfo.SharedDependenciesRPath;
             }
             
             outAllRecompileNeeded = scriptInfo.IsAllCompiledCacheInvalidated(*lastInfo);
@@ -516,16 +567,23 @@ namespace runcpp2
     }
     
     
+    //NOTE: Populates, setups and syncs the dependencies, and records their revisions to the 
+    //      lockfile. Git dependencies not at the locked revisions are populated again.
+    //      Dependencies that are ready from the last run are skipped.
+    //      The include paths of the dependencies are available after this.
     inline DS::Result<void>
-    ProcessDependencies(Data::ScriptInfo& scriptInfo,
+    PrepareDependencies(Data::ScriptInfo& scriptInfo,
                         const Data::Profile& profile,
                         const ghc::filesystem::path& scriptDirectory,
                         const ghc::filesystem::path& buildDir,
+                        const ghc::filesystem::path& lockFilePath,
                         const std::vector<std::string>& changedDependencies,
                         bool buildSourceOnly,
-                        const int maxThreads,
+                        JobPool& jobPool,
                         std::vector<Data::DependencyInfo*>& outAvailableDependencies,
-                        std::vector<std::string>& outGatheredBinariesPaths)
+                        std::vector<std::string>& outDependenciesLocalCopiesPaths,
+                        std::vector<bool>& outDependenciesReady,
+                        std::vector<Data::DependencyReadyRecord>& outDependenciesRecords)
     {
         ssLOG_FUNC_INFO();
         
@@ -535,15 +593,71 @@ namespace runcpp2
                 outAvailableDependencies.push_back(&scriptInfo.Dependencies.at(i));
         }
         
-        std::vector<std::string> dependenciesLocalCopiesPaths;
         std::vector<std::string> dependenciesSourcePaths;
         GetDependenciesPaths(   outAvailableDependencies,
-                                dependenciesLocalCopiesPaths,
+                                outDependenciesLocalCopiesPaths,
                                 dependenciesSourcePaths,
                                 scriptDirectory,
                                 buildDir).DS_TRY();
         
-        if(!changedDependencies.empty())
+        Data::DependenciesLock lock;
+        ReadDependenciesLock(lockFilePath, lock).DS_TRY();
+        
+        //Local dependencies that are already populated are synced here, which gives the 
+        //revisions for checking if they are ready. The rest are synced after being populated.
+        std::vector<std::string> localRevisions(outAvailableDependencies.size());
+        for(int i = 0; i < outAvailableDependencies.size(); ++i)
+        {
+            const Data::DependencyInfo& dependency = *outAvailableDependencies.at(i);
+            std::error_code e;
+            if( !mpark::get_if<Data::LocalSource>(&(dependency.Source.Source)) ||
+                !ghc::filesystem::is_directory(outDependenciesLocalCopiesPaths.at(i), e) ||
+                std::find(  changedDependencies.begin(), 
+                            changedDependencies.end(), 
+                            dependency.Name) != changedDependencies.end())
+            {
+                continue;
+            }
+            
+            SyncLocalDependency(dependency,
+                                dependenciesSourcePaths.at(i),
+                                outDependenciesLocalCopiesPaths.at(i),
+                                &localRevisions.at(i)).DS_TRY();
+        }
+        
+        GetReadyDependencies(   profile,
+                                buildDir,
+                                outAvailableDependencies,
+                                outDependenciesLocalCopiesPaths,
+                                localRevisions,
+                                lock,
+                                changedDependencies,
+                                outDependenciesReady,
+                                outDependenciesRecords).DS_TRY();
+        
+        //Only the dependencies that are not ready need to be processed
+        std::vector<Data::DependencyInfo*> pendingDependencies;
+        std::vector<std::string> pendingCopiesPaths;
+        std::vector<std::string> pendingSourcePaths;
+        std::vector<std::string> pendingRevisions;
+        for(int i = 0; i < outAvailableDependencies.size(); ++i)
+        {
+            if(outDependenciesReady.at(i))
+                continue;
+            
+            pendingDependencies.push_back(outAvailableDependencies.at(i));
+            pendingCopiesPaths.push_back(outDependenciesLocalCopiesPaths.at(i));
+            pendingSourcePaths.push_back(dependenciesSourcePaths.at(i));
+            pendingRevisions.push_back(localRevisions.at(i));
+        }
+        
+        std::vector<std::string> dependenciesToReset = changedDependencies;
+        GetDependenciesNotAtLockedRevisions(pendingDependencies,
+                                            pendingCopiesPaths,
+                                            lock,
+                                            dependenciesToReset);
+        
+        if(!dependenciesToReset.empty())
         {
             if(buildSourceOnly)
             {
@@ -552,37 +666,97 @@ namespace runcpp2
                                     "dependencies");
             }
             
-            std::string depsToReset = changedDependencies[0];
-            for(int i = 1; i < changedDependencies.size(); ++i)
-                depsToReset += "," + changedDependencies[i];
+            std::string depsToReset = dependenciesToReset[0];
+            for(int i = 1; i < dependenciesToReset.size(); ++i)
+                depsToReset += "," + dependenciesToReset[i];
             
             CleanupDependencies(profile,
                                 scriptInfo,
                                 outAvailableDependencies,
-                                dependenciesLocalCopiesPaths,
+                                outDependenciesLocalCopiesPaths,
                                 depsToReset).DS_TRY();
+            
+            //The copies of the reset dependencies are populated and synced again
+            for(int i = 0; i < pendingDependencies.size(); ++i)
+            {
+                if(std::find(   dependenciesToReset.begin(), 
+                                dependenciesToReset.end(), 
+                                pendingDependencies.at(i)->Name) != dependenciesToReset.end())
+                {
+                    pendingRevisions.at(i).clear();
+                }
+            }
         }
         
         SetupDependenciesIfNeeded(  profile, 
                                     buildDir,
                                     scriptInfo, 
-                                    outAvailableDependencies,
-                                    dependenciesLocalCopiesPaths,
-                                    dependenciesSourcePaths,
-                                    maxThreads).DS_TRY();
+                                    pendingDependencies,
+                                    pendingCopiesPaths,
+                                    pendingSourcePaths,
+                                    lock,
+                                    jobPool).DS_TRY();
 
         //Sync local dependencies before building
-        SyncLocalDependencies(  outAvailableDependencies,
-                                dependenciesSourcePaths,
-                                dependenciesLocalCopiesPaths).DS_TRY();
-
-        if(!buildSourceOnly)
+        SyncLocalDependencies(  pendingDependencies,
+                                pendingSourcePaths,
+                                pendingCopiesPaths,
+                                pendingRevisions).DS_TRY();
+        
+        UpdateDependenciesLock( scriptInfo,
+                                pendingDependencies,
+                                pendingCopiesPaths,
+                                lockFilePath,
+                                lock,
+                                pendingRevisions).DS_TRY();
+        
+        for(int i = 0, pendingIndex = 0; i < outAvailableDependencies.size(); ++i)
+        {
+            if(!outDependenciesReady.at(i))
+                outDependenciesRecords.at(i).Revision = pendingRevisions.at(pendingIndex++);
+        }
+        
+        return {};
+    }
+    
+    //NOTE: Builds the prepared dependencies and gathers their binaries, and records the 
+    //      dependencies as ready. Ready dependencies use the binaries in their records instead.
+    //      This doesn't touch the script sources so it can run while they are being compiled.
+    inline DS::Result<void>
+    BuildAndGatherDependencies( const Data::ScriptInfo& scriptInfo,
+                                const Data::Profile& profile,
+                                const ghc::filesystem::path& buildDir,
+                                const std::vector<Data::DependencyInfo*>& availableDependencies,
+                                const std::vector<std::string>& dependenciesLocalCopiesPaths,
+                                const std::vector<bool>& dependenciesReady,
+                                std::vector<Data::DependencyReadyRecord>& dependenciesRecords,
+                                bool buildSourceOnly,
+                                JobPool& jobPool,
+                                std::vector<std::string>& outGatheredBinariesPaths)
+    {
+        ssLOG_FUNC_INFO();
+        
+        std::vector<Data::DependencyInfo*> pendingDependencies;
+        std::vector<std::string> pendingCopiesPaths;
+        std::vector<std::string> pendingRevisions;
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            if(dependenciesReady.at(i))
+                continue;
+            
+            pendingDependencies.push_back(availableDependencies.at(i));
+            pendingCopiesPaths.push_back(dependenciesLocalCopiesPaths.at(i));
+            pendingRevisions.push_back(dependenciesRecords.at(i).Revision);
+        }
+        
+        if(!buildSourceOnly && !pendingDependencies.empty())
         {
             BuildDependencies(  profile,
                                 scriptInfo,
-                                outAvailableDependencies, 
-                                dependenciesLocalCopiesPaths,
-                                maxThreads)
+                                pendingDependencies, 
+                                pendingCopiesPaths,
+                                pendingRevisions,
+                                jobPool)
                 .DS_TRY_ACT
                 (
                     DS_TMP_ERROR.Message += 
@@ -592,12 +766,86 @@ namespace runcpp2
                     return DS::Error(DS_TMP_ERROR);
                 );
         }
-
-        GatherDependenciesBinaries( outAvailableDependencies,
-                                    dependenciesLocalCopiesPaths,
+        
+        //Gather the pending dependencies together so that the search directories are only listed 
+        //once. The binaries are still recorded for each of them. Ready dependencies use the 
+        //binaries they gathered last time.
+        std::vector<std::string> pendingBinariesPaths;
+        std::vector<std::vector<std::string>> pendingDependenciesBinariesPaths;
+        GatherDependenciesBinaries( pendingDependencies,
+                                    pendingCopiesPaths,
                                     profile,
+                                    pendingBinariesPaths,
+                                    &pendingDependenciesBinariesPaths).DS_TRY();
+        
+        std::vector<std::vector<std::string>> dependenciesBinariesPaths;
+        for(int i = 0, pendingIndex = 0; i < availableDependencies.size(); ++i)
+        {
+            Data::DependencyReadyRecord& record = dependenciesRecords.at(i);
+            if(!dependenciesReady.at(i))
+                record.BinariesPaths = pendingDependenciesBinariesPaths.at(pendingIndex++);
+            
+            dependenciesBinariesPaths.push_back(record.BinariesPaths);
+        }
+        
+        MergeDependenciesBinaries(dependenciesBinariesPaths, outGatheredBinariesPaths);
+        
+        //The dependencies are not built if only building the sources, so they are not ready yet
+        if(buildSourceOnly)
+            return {};
+        
+        //Dependencies without revisions can't be checked if they have changed
+        std::vector<Data::DependencyReadyRecord> readyRecords = dependenciesRecords;
+        for(int i = 0; i < readyRecords.size(); ++i)
+        {
+            if(readyRecords.at(i).Revision.empty())
+                readyRecords.at(i).Key.clear();
+        }
+        
+        WriteDependenciesReadyRecords(buildDir, availableDependencies, readyRecords).DS_TRY();
+        return {};
+    }
+    
+    inline DS::Result<void>
+    ProcessDependencies(Data::ScriptInfo& scriptInfo,
+                        const Data::Profile& profile,
+                        const ghc::filesystem::path& scriptDirectory,
+                        const ghc::filesystem::path& buildDir,
+                        const ghc::filesystem::path& lockFilePath,
+                        const std::vector<std::string>& changedDependencies,
+                        bool buildSourceOnly,
+                        JobPool& jobPool,
+                        std::vector<Data::DependencyInfo*>& outAvailableDependencies,
+                        std::vector<std::string>& outGatheredBinariesPaths)
+    {
+        ssLOG_FUNC_INFO();
+        
+        std::vector<std::string> dependenciesLocalCopiesPaths;
+        std::vector<bool> dependenciesReady;
+        std::vector<Data::DependencyReadyRecord> dependenciesRecords;
+        PrepareDependencies(scriptInfo,
+                            profile,
+                            scriptDirectory,
+                            buildDir,
+                            lockFilePath,
+                            changedDependencies,
+                            buildSourceOnly,
+                            jobPool,
+                            outAvailableDependencies,
+                            dependenciesLocalCopiesPaths,
+                            dependenciesReady,
+                            dependenciesRecords).DS_TRY();
+        
+        BuildAndGatherDependencies( scriptInfo,
+                                    profile,
+                                    buildDir,
+                                    outAvailableDependencies,
+                                    dependenciesLocalCopiesPaths,
+                                    dependenciesReady,
+                                    dependenciesRecords,
+                                    buildSourceOnly,
+                                    jobPool,
                                     outGatheredBinariesPaths).DS_TRY();
-
         return {};
     }
 
@@ -661,7 +909,93 @@ namespace runcpp2
         
         INTERNAL_RUNCPP2_SAFE_CATCH_RETURN(void());
     }
+    
+    //NOTE: Outputs the directories of the linked shared libraries in the files to copy so that 
+    //      they can be found with rpath. They are removed from the files to copy unless 
+    //      keepFilesToCopy. Other shared libraries (such as the ones in FilesToCopy) are still 
+    //      copied since they are not linked and can be loaded from anywhere.
+    inline void SeparateRPathDependencyFiles(   const Data::Profile& profile,
+                                                const std::vector<Data::DependencyInfo*>& 
+                                                    availableDependencies,
+                                                const std::vector<std::string>& 
+                                                    dependenciesLocalCopiesPaths,
+                                                const std::vector<ghc::filesystem::path>& 
+                                                    linkFilesPaths,
+                                                bool keepFilesToCopy,
+                                                std::vector<ghc::filesystem::path>& 
+                                                    inOutFilesToCopyPaths,
+                                                std::vector<std::string>& outRPathDirectories)
+    {
+        ssLOG_FUNC_INFO();
+        
+        if(!runcpp2::HasValueFromPlatformMap(profile.FilesTypes.SharedLibraryFile.Extension))
+            return;
+        
+        const std::string& sharedLibraryExtension = 
+            *runcpp2::GetValueFromPlatformMap(profile.FilesTypes.SharedLibraryFile.Extension);
+        
+        //Files listed in FilesToCopy are gathered the same way as the linked files
+        std::unordered_set<std::string> listedFilesToCopy;
+        for(int i = 0; i < availableDependencies.size(); ++i)
+        {
+            const Data::FilesToCopyInfo* filesToCopy = 
+                runcpp2::GetValueFromPlatformMap(availableDependencies.at(i)->FilesToCopy);
+            if(filesToCopy == nullptr)
+                continue;
+            
+            const std::vector<std::string>* profileFiles = 
+                runcpp2::GetValueFromProfileMap(profile, filesToCopy->ProfileFiles);
+            if(profileFiles == nullptr)
+                continue;
+            
+            for(int j = 0; j < profileFiles->size(); ++j)
+            {
+                const ghc::filesystem::path filePath = 
+                    ghc::filesystem::path(dependenciesLocalCopiesPaths.at(i)) / profileFiles->at(j);
+                listedFilesToCopy.insert(runcpp2::ProcessPath(filePath.string()));
+            }
+        }
+        
+        std::vector<ghc::filesystem::path> otherFilesToCopyPaths;
+        for(int i = 0; i < inOutFilesToCopyPaths.size(); ++i)
+        {
+            const ghc::filesystem::path& filePath = inOutFilesToCopyPaths.at(i);
+            if( runcpp2::GetFileExtensionWithoutVersion(filePath) != sharedLibraryExtension || 
+                std::find(linkFilesPaths.begin(), linkFilesPaths.end(), filePath) == 
+                linkFilesPaths.end() ||
+                listedFilesToCopy.count(filePath.string()) > 0)
+            {
+                otherFilesToCopyPaths.push_back(filePath);
+                continue;
+            }
+            
+            const std::string directory = runcpp2::ProcessPath(filePath.parent_path().string());
+            if( std::find(outRPathDirectories.begin(), outRPathDirectories.end(), directory) == 
+                outRPathDirectories.end())
+            {
+                ssLOG_DEBUG("Adding rpath directory " << directory);
+                outRPathDirectories.push_back(directory);
+            }
+            
+            if(keepFilesToCopy)
+                otherFilesToCopyPaths.push_back(filePath);
+        }
+        
+        inOutFilesToCopyPaths = otherFilesToCopyPaths;
+    }
 
+    inline bool HasPreBuildCommands(const Data::ScriptInfo& scriptInfo, const Data::Profile& profile)
+    {
+        const Data::ProfilesCommands* preBuildCommands = 
+            runcpp2::GetValueFromPlatformMap(scriptInfo.PreBuild);
+        if(preBuildCommands == nullptr)
+            return false;
+        
+        const std::vector<std::string>* commandSteps = 
+            runcpp2::GetValueFromProfileMap(profile, preBuildCommands->CommandSteps);
+        return commandSteps != nullptr && !commandSteps->empty();
+    }
+    
     inline DS::Result<void> HandlePreBuild( const Data::ScriptInfo& scriptInfo,
                                             const Data::Profile& profile,
                                             const ghc::filesystem::path& buildDir)
@@ -875,6 +1209,159 @@ namespace runcpp2
         
         return {};
     }
+    
+    //NOTE: Groups the other source files into at most maxThreads unity sources per extension.
+    //      Each source is assigned to a bucket by the hash of its path so that the grouping
+    //      stays the same across edits, and only the affected unity source needs recompiling.
+    //      The script itself and the excluded sources are still compiled individually.
+    inline DS::Result<void>
+    GroupUnitySourceFiles(  const ghc::filesystem::path& absoluteScriptPath,
+                            const Data::ScriptInfo& scriptInfo,
+                            const Data::Profile& currentProfile,
+                            const ghc::filesystem::path& buildDir,
+                            const int maxThreads,
+                            std::vector<ghc::filesystem::path>& inOutSourcePaths)
+    {
+        ssLOG_FUNC_INFO();
+        
+        if(!scriptInfo.UnityBuild)
+            return {};
+        
+        if(maxThreads <= 0)
+            return DS_ERROR_MSG("Invalid number of threads passed in");
+        
+        const ghc::filesystem::path scriptDirectory = absoluteScriptPath.parent_path();
+        
+        //Get the sources that must not be grouped
+        std::unordered_set<std::string> excludedSources;
+        excludedSources.insert(absoluteScriptPath.lexically_normal().string());
+        {
+            const Data::ProfilesProcessPaths* excludedFiles =
+                GetValueFromPlatformMap(scriptInfo.UnityExcludedSourceFiles);
+            
+            const std::vector<ghc::filesystem::path>* profileExcludedFiles =
+                excludedFiles == nullptr ?
+                nullptr :
+                GetValueFromProfileMap(currentProfile, excludedFiles->Paths);
+            
+            if(profileExcludedFiles != nullptr)
+            {
+                for(int i = 0; i < profileExcludedFiles->size(); ++i)
+                {
+                    ghc::filesystem::path currentPath = profileExcludedFiles->at(i);
+                    if(currentPath.is_relative())
+                        currentPath = scriptDirectory / currentPath;
+                    
+                    excludedSources.insert(currentPath.lexically_normal().string());
+                }
+            }
+        }
+        
+        //Assign each source to a bucket
+        std::vector<ghc::filesystem::path> individualSources;
+        std::map<std::string, std::map<int, std::vector<ghc::filesystem::path>>> extensionBuckets;
+        for(int i = 0; i < inOutSourcePaths.size(); ++i)
+        {
+            const ghc::filesystem::path& currentSource = inOutSourcePaths.at(i);
+            if(excludedSources.count(currentSource.lexically_normal().string()) > 0)
+            {
+                ssLOG_DEBUG("Not grouping " << currentSource.string() << " for unity build");
+                individualSources.push_back(currentSource);
+                continue;
+            }
+            
+            std::error_code e;
+            ghc::filesystem::path relativeSourcePath =
+                ghc::filesystem::relative(currentSource, scriptDirectory, e);
+            if(e)
+            {
+                return DS_ERROR_MSG("Failed to get relative path for " + currentSource.string() +
+                                    "\nFailed with error: " + e.message());
+            }
+            
+            std::size_t pathHash = std::hash<std::string>{}(relativeSourcePath.generic_string());
+            int bucketIndex = static_cast<int>(pathHash % static_cast<std::size_t>(maxThreads));
+            extensionBuckets[currentSource.extension().string()][bucketIndex]
+                .push_back(currentSource);
+        }
+        
+        //Generate the unity sources, only write them when the content has changed
+        const ghc::filesystem::path unityDir = buildDir / "UnitySources";
+        std::error_code e;
+        if(!ghc::filesystem::exists(unityDir, e) && !ghc::filesystem::create_directories(unityDir, e))
+            return DS_ERROR_MSG("Failed to create directory: " + unityDir.string());
+        
+        std::unordered_set<std::string> generatedSources;
+        std::vector<ghc::filesystem::path> unitySources;
+        for(const auto& extensionIt : extensionBuckets)
+        {
+            for(const auto& bucketIt : extensionIt.second)
+            {
+                std::vector<ghc::filesystem::path> bucketSources = bucketIt.second;
+                
+                //Nothing to group with, just compile it as it is
+                if(bucketSources.size() == 1)
+                {
+                    individualSources.push_back(bucketSources.front());
+                    continue;
+                }
+                
+                std::sort(bucketSources.begin(), bucketSources.end());
+                
+                std::string unityContent = "//Generated by runcpp2 for unity build, do not edit\n";
+                for(int i = 0; i < bucketSources.size(); ++i)
+                    unityContent += "#include \"" + bucketSources.at(i).generic_string() + "\"\n";
+                
+                ghc::filesystem::path unitySourcePath =
+                    unityDir / ("Unity_" + std::to_string(bucketIt.first) + extensionIt.first);
+                
+                std::string existingContent;
+                if(ghc::filesystem::exists(unitySourcePath, e))
+                {
+                    std::ifstream unityFile(unitySourcePath);
+                    std::stringstream buffer;
+                    buffer << unityFile.rdbuf();
+                    existingContent = buffer.str();
+                }
+                
+                if(existingContent != unityContent)
+                {
+                    ssLOG_INFO("Writing unity source " << unitySourcePath.string());
+                    std::ofstream unityFile(unitySourcePath, std::ios::binary);
+                    if(!unityFile)
+                        return DS_ERROR_MSG("Failed to write unity source: " + unitySourcePath.string());
+                    
+                    unityFile << unityContent;
+                }
+                
+                generatedSources.insert(unitySourcePath.string());
+                unitySources.push_back(unitySourcePath);
+            }
+        }
+        
+        //Remove unity sources that are no longer used
+        std::vector<ghc::filesystem::path> unusedSources;
+        for(auto it = ghc::filesystem::directory_iterator(unityDir, e);
+            it != ghc::filesystem::directory_iterator();
+            it.increment(e))
+        {
+            if(e)
+                break;
+            
+            if(it->is_regular_file(e) && generatedSources.count(it->path().string()) == 0)
+                unusedSources.push_back(it->path());
+        }
+        
+        for(int i = 0; i < unusedSources.size(); ++i)
+        {
+            ssLOG_DEBUG("Removing unused unity source " << unusedSources.at(i).string());
+            ghc::filesystem::remove(unusedSources.at(i), e);
+        }
+        
+        inOutSourcePaths = individualSources;
+        inOutSourcePaths.insert(inOutSourcePaths.end(), unitySources.begin(), unitySources.end());
+        return {};
+    }
 
     inline DS::Result<void> 
     GatherIncludePaths( const ghc::filesystem::path& scriptDirectory, 
@@ -951,12 +1438,20 @@ namespace runcpp2
         return {};
     }
 
-    using SourceIncludeMap = std::unordered_map<std::string, std::vector<ghc::filesystem::path>>;
+    //NOTE: outSourceIncludePathsUsed are the include paths that the includes of each source are 
+    //      found in. Sources with includes that can't be parsed (such as macro includes, 
+    //      #include_next or __has_include) or quoted includes that are not found are not in it 
+    //      since the include paths they use are unknown.
+    //      Angle includes that are not found are assumed to be system headers, unless 
+    //      unresolvedIncludesUnknown is set, in which case they are treated as unknown as well 
+    //      (e.g. the header might be generated by a dependency that is still being built).
     inline DS::Result<void> 
     GatherFilesIncludes(const std::vector<ghc::filesystem::path>& sourceFiles,
                         const std::vector<bool>& sourceHasCache,
                         const std::vector<ghc::filesystem::path>& includePaths,
-                        SourceIncludeMap& outSourceIncludeMap)
+                        const bool unresolvedIncludesUnknown,
+                        SourceIncludeMap& outSourceIncludeMap,
+                        SourceIncludeMap& outSourceIncludePathsUsed)
     {
         ssLOG_FUNC_INFO();
         
@@ -964,6 +1459,7 @@ namespace runcpp2
             return DS_ERROR_MSG("Size of sourceFiles and sourceHasCache not matching");
         
         outSourceIncludeMap.clear();
+        outSourceIncludePathsUsed.clear();
         
         for(int i = 0; i < sourceFiles.size(); ++i)
         {
@@ -979,6 +1475,9 @@ namespace runcpp2
             std::queue<ghc::filesystem::path> filesToProcess;
             filesToProcess.push(source);
             
+            std::vector<bool> includePathsUsed(includePaths.size(), false);
+            bool includePathsKnown = true;
+            
             while(!filesToProcess.empty())
             {
                 ghc::filesystem::path currentFile = filesToProcess.front();
@@ -996,15 +1495,23 @@ namespace runcpp2
                 std::string line;
                 while(std::getline(fileStream, line))
                 {
+                    if(includePathsKnown && !IsIncludeResolvable(line))
+                    {
+                        ssLOG_DEBUG("Include paths used by " << source.string() << 
+                                    " are unknown because of: " << line);
+                        includePathsKnown = false;
+                    }
+                    
                     std::string includePath;
                     if(!ParseIncludes(line, includePath))
                         continue;
-                        
+                    
                     ghc::filesystem::path resolvedInclude;
                     bool found = false;
+                    const bool isQuoted = line.find('\"') != std::string::npos;
                     
                     //For quoted includes, first check relative to source file
-                    if(line.find('\"') != std::string::npos)
+                    if(isQuoted)
                     {
                         resolvedInclude = currentFile.parent_path() / includePath;
                         std::error_code ec;
@@ -1015,13 +1522,14 @@ namespace runcpp2
                     //Search in include paths if not found
                     if(!found)
                     {
-                        for(const ghc::filesystem::path& searchPath : includePaths)
+                        for(int j = 0; j < includePaths.size(); ++j)
                         {
-                            resolvedInclude = searchPath / includePath;
+                            resolvedInclude = includePaths.at(j) / includePath;
                             std::error_code ec;
                             if(ghc::filesystem::exists(resolvedInclude, ec))
                             {
                                 found = true;
+                                includePathsUsed.at(j) = true;
                                 break;
                             }
                         }
@@ -1033,8 +1541,28 @@ namespace runcpp2
                         currentIncludes.push_back(resolvedInclude);
                         filesToProcess.push(resolvedInclude);
                     }
+                    //Quoted includes are not expected to be system headers. It could be a header 
+                    //that is generated when building the dependencies, which is in an unknown 
+                    //include path.
+                    else if((isQuoted || unresolvedIncludesUnknown) && includePathsKnown)
+                    {
+                        ssLOG_DEBUG("Include paths used by " << source.string() << 
+                                    " are unknown because " << includePath << " is not found");
+                        includePathsKnown = false;
+                    }
                 }
             }
+            
+            if(!includePathsKnown)
+                continue;
+            
+            std::vector<ghc::filesystem::path>& currentIncludePathsUsed = 
+                outSourceIncludePathsUsed[source.string()];
+            for(int j = 0; j < includePaths.size(); ++j)
+            {
+                if(includePathsUsed.at(j))
+                    currentIncludePathsUsed.push_back(includePaths.at(j));
+            }
         }
         
         return {};
@@ -2,6 +2,8 @@
 #define RUNCPP2_PLATFORM_UTIL_HPP
 
 #include "runcpp2/Data/ParseCommon.hpp"
+#include "runcpp2/SubprocessManager.hpp"
+#include "runcpp2/Jobserver.hpp"
 
 #if !defined(NOMINMAX)
     #define NOMINMAX 1
@@ -11,14 +13,31 @@
 #include "ssLogger/ssLog.hpp"
 #include "ghc/filesystem.hpp"
 
+#include <atomic>
 #include <cctype>
 #include <cstdint>
+#include <functional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <system_error>
+#include <thread>
+
+#if !defined(_WIN32)
+    #include <stdlib.h>
+#endif
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <linux/fs.h>
+    #include <sys/ioctl.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
 
 #if !defined(INTERNAL_RUNCPP2_UNIT_TESTS) || !INTERNAL_RUNCPP2_UNIT_TESTS
     #define CO_NO_OVERRIDE 1
@@ -96,14 +115,73 @@ namespace runcpp2
         #endif
     }
     
+    //NOTE: outPeakMemoryKB is set to the peak memory used by the command if it is supported 
+    //      on the current platform, otherwise it is set to 0.
+    //      The command is terminated once cancelFlag is set and NotifyCommandsCancelled() is 
+    //      called if it is supported on the current platform, otherwise the command runs until it 
+    //      finishes.
+    //      If jobserver is given, the command can use it if it is supported on the current 
+    //      platform.
     inline bool RunCommand( const std::string& command, 
                             const bool& captureOutput,
                             const std::string& runDirectory, 
                             std::string& outOutput, 
-                            int& outReturnCode)
+                            int& outReturnCode,
+                            int64_t* outPeakMemoryKB = nullptr,
+                            const std::atomic<bool>* cancelFlag = nullptr,
+                            const Jobserver* jobserver = nullptr)
     {
         ssLOG_FUNC_DEBUG();
         ssLOG_DEBUG("Running: " << command);
+        
+        if(outPeakMemoryKB)
+            *outPeakMemoryKB = 0;
+        
+        #if defined(__linux__)
+        {
+            std::vector<std::string> environmentOverrides;
+            std::vector<std::pair<int, int>> inheritedFds;
+            if(jobserver && !jobserver->GetMakeFlags().empty())
+            {
+                environmentOverrides.push_back("MAKEFLAGS=" + jobserver->GetMakeFlags());
+                inheritedFds = jobserver->GetFds();
+            }
+            
+            SubprocessResult result = 
+                SubprocessManager::GetInstance().Start( command, 
+                                                        captureOutput, 
+                                                        runDirectory,
+                                                        cancelFlag,
+                                                        environmentOverrides,
+                                                        inheritedFds).get();
+            
+            if(!result.Started)
+            {
+                ssLOG_ERROR("Failed to start command: " << command);
+                return false;
+            }
+            
+            outOutput = captureOutput ? std::move(result.Output) : "";
+            outReturnCode = result.ReturnCode;
+            if(outPeakMemoryKB)
+                *outPeakMemoryKB = result.PeakMemoryKB;
+            
+            if(captureOutput)
+                ssLOG_DEBUG("outOutput: \n" << outOutput.c_str());
+            
+            if(outReturnCode != 0)
+            {
+                ssLOG_DEBUG("Failed when running command with return code: " << outReturnCode);
+                return false;
+            }
+            
+            return true;
+        }
+        #else
+            (void)cancelFlag;
+            (void)jobserver;
+        #endif
+        
         System2CommandInfo commandInfo = {};
         if(!runDirectory.empty())
             commandInfo.RunDirectory = runDirectory.c_str();
@@ -157,6 +235,81 @@ namespace runcpp2
         System2CleanupCommand(&commandInfo);
         return true;
     }
+    
+    //NOTE: Starts the command without waiting for it, onFinished is called with the result once 
+    //      the command finishes. On Linux, onFinished is called from the thread waiting for all 
+    //      the commands so it must not block. Other platforms use a thread to wait for each 
+    //      command instead.
+    //      The command is terminated once cancelFlag is set and NotifyCommandsCancelled() is 
+    //      called if it is supported on the current platform, otherwise the command runs until it 
+    //      finishes.
+    inline void RunCommandAsync(const std::string& command, 
+                                const bool captureOutput,
+                                const std::string& runDirectory, 
+                                const std::function<void(SubprocessResult)>& onFinished,
+                                const std::atomic<bool>* cancelFlag = nullptr)
+    {
+        ssLOG_FUNC_DEBUG();
+        ssLOG_DEBUG("Running: " << command);
+        
+        #if defined(__linux__)
+            SubprocessManager::GetInstance().StartAsync(command, 
+                                                        captureOutput, 
+                                                        runDirectory, 
+                                                        onFinished,
+                                                        cancelFlag);
+        #else
+            (void)cancelFlag;
+            std::thread
+            (
+                [command, captureOutput, runDirectory, onFinished]()
+                {
+                    SubprocessResult result;
+                    result.Started = true;
+                    const bool succeeded = RunCommand(  command, 
+                                                        captureOutput, 
+                                                        runDirectory, 
+                                                        result.Output, 
+                                                        result.ReturnCode);
+                    if(succeeded)
+                        result.ReturnCode = 0;
+                    else if(result.ReturnCode == 0)
+                        result.ReturnCode = -1;
+                    
+                    onFinished(std::move(result));
+                }
+            ).detach();
+        #endif
+    }
+    
+    //NOTE: Needs to be called after setting the cancelFlag of any running command
+    inline void NotifyCommandsCancelled()
+    {
+        #if defined(__linux__)
+            SubprocessManager::GetInstance().Wake();
+        #endif
+    }
+    
+    //NOTE: Falls back to 8 if the number of hardware threads can't be detected
+    inline int GetHardwareThreadsCount()
+    {
+        unsigned int hardwareThreads = std::thread::hardware_concurrency();
+        return hardwareThreads == 0 ? 8 : static_cast<int>(hardwareThreads);
+    }
+    
+    //NOTE: Uses the hardware threads that are not already busy with other processes
+    inline int GetDefaultMaxThreads()
+    {
+        int maxThreads = GetHardwareThreadsCount();
+        
+        #if !defined(_WIN32)
+            double loadAverage = 0;
+            if(getloadavg(&loadAverage, 1) == 1)
+                maxThreads -= static_cast<int>(loadAverage + 0.5);
+        #endif
+        
+        return maxThreads < 1 ? 1 : maxThreads;
+    }
 
     #if defined(_WIN32)
         inline std::string GetWindowsError()
@@ -243,6 +396,95 @@ namespace runcpp2
         return "";
     }
     
+    //NOTE: Sources generated by runcpp2 (i.e. unity sources) live inside the build directory, 
+    //      their output paths are therefore relative to the build directory instead.
+    inline ghc::filesystem::path GetSourceRelativePath( const ghc::filesystem::path& source,
+                                                        const ghc::filesystem::path& scriptDirectory,
+                                                        const ghc::filesystem::path& buildDir,
+                                                        std::error_code& outError)
+    {
+        ghc::filesystem::path relativeToBuildDir = 
+            ghc::filesystem::relative(source, buildDir, outError);
+        
+        if(!outError && !relativeToBuildDir.empty() && *relativeToBuildDir.begin() != "..")
+            return relativeToBuildDir;
+        
+        outError.clear();
+        return ghc::filesystem::relative(source, scriptDirectory, outError);
+    }
+    
+    //NOTE: Copies a regular file, overwriting the destination if it exists. On Linux, the file is 
+    //      reflinked (FICLONE) if the filesystem supports it, which shares the data blocks until 
+    //      either file is modified. Otherwise copy_file_range is used so that the data is copied 
+    //      in the kernel, and finally it falls back to a normal copy.
+    inline bool CloneOrCopyFile(const ghc::filesystem::path& srcPath,
+                                const ghc::filesystem::path& destPath,
+                                std::error_code& outError)
+    {
+        outError.clear();
+        
+        #if defined(__linux__)
+        {
+            //Truncating the destination would also truncate the source if they are the same file
+            if(ghc::filesystem::equivalent(srcPath, destPath, outError))
+            {
+                outError = std::make_error_code(std::errc::file_exists);
+                return false;
+            }
+            outError.clear();
+            
+            bool copied = false;
+            int srcFd = open(srcPath.c_str(), O_RDONLY | O_CLOEXEC);
+            struct stat srcStat;
+            if(srcFd >= 0 && fstat(srcFd, &srcStat) == 0 && S_ISREG(srcStat.st_mode))
+            {
+                int destFd = open(  destPath.c_str(), 
+                                    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | O_NOFOLLOW, 
+                                    srcStat.st_mode & 07777);
+                if(destFd >= 0)
+                {
+                    #if defined(FICLONE)
+                        copied = ioctl(destFd, FICLONE, srcFd) == 0;
+                    #endif
+                    
+                    #if defined(SYS_copy_file_range)
+                        off_t remainingBytes = srcStat.st_size;
+                        while(!copied && remainingBytes > 0)
+                        {
+                            long copiedBytes = syscall( SYS_copy_file_range, 
+                                                        srcFd, 
+                                                        nullptr, 
+                                                        destFd, 
+                                                        nullptr, 
+                                                        static_cast<size_t>(remainingBytes), 
+                                                        0);
+                            if(copiedBytes <= 0)
+                                break;
+                            
+                            remainingBytes -= copiedBytes;
+                        }
+                        copied = copied || remainingBytes == 0;
+                    #endif
+                    
+                    copied = copied && fchmod(destFd, srcStat.st_mode & 07777) == 0;
+                    copied = close(destFd) == 0 && copied;
+                }
+            }
+            
+            if(srcFd >= 0)
+                close(srcFd);
+            
+            if(copied)
+                return true;
+        }
+        #endif
+        
+        return ghc::filesystem::copy_file(  srcPath, 
+                                            destPath, 
+                                            ghc::filesystem::copy_options::overwrite_existing, 
+                                            outError);
+    }
+    
     //From https://stackoverflow.com/a/58523115
     using time_point = std::chrono::system_clock::time_point;
     std::string SerializeTimePoint(const time_point& time, const std::string& format = "%Y-%m-%d_%H:%M:%S")
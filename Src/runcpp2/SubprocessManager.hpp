@@ -0,0 +1,506 @@
+#ifndef RUNCPP2_SUBPROCESS_MANAGER_HPP
+#define RUNCPP2_SUBPROCESS_MANAGER_HPP
+
+#include <cstdint>
+#include <string>
+
+#if defined(__linux__)
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <spawn.h>
+    #include <sys/resource.h>
+    #include <sys/syscall.h>
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+    
+    #include <atomic>
+    #include <cstring>
+    #include <functional>
+    #include <future>
+    #include <memory>
+    #include <mutex>
+    #include <thread>
+    #include <utility>
+    #include <vector>
+    
+    extern char** environ;
+#endif
+
+namespace runcpp2
+{
+    struct SubprocessResult
+    {
+        bool Started = false;
+        int ReturnCode = -1;
+        std::string Output;
+        int64_t PeakMemoryKB = 0;
+    };
+
+#if defined(__linux__)
+    //NOTE: Runs commands with posix_spawn and waits for all of them in a single thread.
+    //      The output of all the running commands are read with poll into buffers that grow by
+    //      doubling, and the commands are reaped with wait4 to get the peak memory of each one.
+    //      The exits are polled with pidfds, or with SIGCHLD waking the poll if pidfd_open is not 
+    //      supported, so the waiting thread only wakes up when there's something to do.
+    //      Commands started with StartAsync don't need any thread waiting for them, their results 
+    //      are given to the callbacks from the waiting thread instead.
+    class SubprocessManager
+    {
+    public:
+        inline static SubprocessManager& GetInstance()
+        {
+            static SubprocessManager instance;
+            return instance;
+        }
+        
+        SubprocessManager(const SubprocessManager&) = delete;
+        SubprocessManager& operator=(const SubprocessManager&) = delete;
+        
+        //NOTE: Output contains both stdout and stderr if captureOutput is true,
+        //      otherwise they are inherited from runcpp2.
+        //      If cancelFlag is given, the command runs in its own process group which is 
+        //      terminated once cancelFlag is set and Wake() is called. cancelFlag must outlive 
+        //      the command.
+        //      environmentOverrides ("NAME=VALUE") replace or add to the environment of runcpp2 
+        //      for the command only. inheritedFds are pairs of close-on-exec file descriptors that 
+        //      the command needs to inherit and the file descriptors they are duplicated onto in 
+        //      the command, which must be different. They stay close-on-exec for everything else.
+        inline std::future<SubprocessResult> 
+        Start(  const std::string& command,
+                bool captureOutput,
+                const std::string& runDirectory,
+                const std::atomic<bool>* cancelFlag = nullptr,
+                const std::vector<std::string>& environmentOverrides = {},
+                const std::vector<std::pair<int, int>>& inheritedFds = {})
+        {
+            std::shared_ptr<std::promise<SubprocessResult>> promise = 
+                std::make_shared<std::promise<SubprocessResult>>();
+            std::future<SubprocessResult> result = promise->get_future();
+            
+            StartAsync( command, 
+                        captureOutput, 
+                        runDirectory, 
+                        [promise](SubprocessResult commandResult)
+                        {
+                            promise->set_value(std::move(commandResult));
+                        },
+                        cancelFlag,
+                        environmentOverrides,
+                        inheritedFds);
+            return result;
+        }
+        
+        //NOTE: Wakes up the thread waiting for the commands. Must be called after setting any 
+        //      cancelFlag, since the flags are only checked when the thread wakes up.
+        inline void Wake()
+        {
+            if(WakePipe[1] < 0)
+                return;
+            
+            char wakeByte = 0;
+            while(write(WakePipe[1], &wakeByte, 1) < 0 && errno == EINTR);
+        }
+        
+        //NOTE: Same as Start, but onFinished is called with the result instead. It is called from 
+        //      the thread waiting for all the commands, so it must not block. If the command 
+        //      fails to start, it is called before returning.
+        inline void StartAsync( const std::string& command,
+                                bool captureOutput,
+                                const std::string& runDirectory,
+                                const std::function<void(SubprocessResult)>& onFinished,
+                                const std::atomic<bool>* cancelFlag = nullptr,
+                                const std::vector<std::string>& environmentOverrides = {},
+                                const std::vector<std::pair<int, int>>& inheritedFds = {})
+        {
+            if(WakePipe[0] < 0)
+            {
+                onFinished(SubprocessResult());
+                return;
+            }
+            
+            std::unique_ptr<Child> child(new Child());
+            child->OnFinished = onFinished;
+            
+            std::string fullCommand = command;
+            if(!runDirectory.empty())
+                fullCommand = "cd " + QuoteForShell(runDirectory) + " && " + command;
+            
+            int outputPipe[2] = { -1, -1 };
+            if(captureOutput && pipe2(outputPipe, O_CLOEXEC) != 0)
+            {
+                onFinished(SubprocessResult());
+                return;
+            }
+            
+            posix_spawn_file_actions_t fileActions;
+            posix_spawn_file_actions_init(&fileActions);
+            if(captureOutput)
+            {
+                posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDOUT_FILENO);
+                posix_spawn_file_actions_adddup2(&fileActions, outputPipe[1], STDERR_FILENO);
+            }
+            
+            //NOTE: The duplicated file descriptors are not close-on-exec, in the child only.
+            //      Duplicating onto the same file descriptor would only clear close-on-exec since 
+            //      glibc 2.29, which is why the target needs to be different.
+            for(int i = 0; i < inheritedFds.size(); ++i)
+            {
+                posix_spawn_file_actions_adddup2(   &fileActions, 
+                                                    inheritedFds.at(i).first, 
+                                                    inheritedFds.at(i).second);
+            }
+            
+            //NOTE: Only commands that can be cancelled get their own process group, otherwise
+            //      they won't be able to read from the terminal
+            posix_spawnattr_t spawnAttributes;
+            posix_spawnattr_init(&spawnAttributes);
+            if(cancelFlag)
+            {
+                posix_spawnattr_setflags(&spawnAttributes, POSIX_SPAWN_SETPGROUP);
+                posix_spawnattr_setpgroup(&spawnAttributes, 0);
+            }
+            
+            std::vector<char*> environment;
+            if(!environmentOverrides.empty())
+            {
+                for(char** it = environ; *it; ++it)
+                {
+                    const std::string entry = *it;
+                    const std::size_t nameLength = entry.find('=');
+                    bool overridden = false;
+                    for(int i = 0; i < environmentOverrides.size() && !overridden; ++i)
+                    {
+                        overridden =    nameLength != std::string::npos &&
+                                        environmentOverrides.at(i).compare( 0, 
+                                                                            nameLength + 1, 
+                                                                            entry, 
+                                                                            0, 
+                                                                            nameLength + 1) == 0;
+                    }
+                    
+                    if(!overridden)
+                        environment.push_back(*it);
+                }
+                
+                for(int i = 0; i < environmentOverrides.size(); ++i)
+                    environment.push_back(const_cast<char*>(environmentOverrides.at(i).c_str()));
+                environment.push_back(nullptr);
+            }
+            
+            const char* args[] = { "sh", "-c", fullCommand.c_str(), nullptr };
+            int spawnResult = posix_spawn(  &child->Pid,
+                                            "/bin/sh",
+                                            &fileActions,
+                                            &spawnAttributes,
+                                            const_cast<char* const*>(args),
+                                            environment.empty() ? environ : environment.data());
+            posix_spawn_file_actions_destroy(&fileActions);
+            posix_spawnattr_destroy(&spawnAttributes);
+            
+            if(captureOutput)
+                close(outputPipe[1]);
+            
+            if(spawnResult != 0)
+            {
+                if(captureOutput)
+                    close(outputPipe[0]);
+                onFinished(SubprocessResult());
+                return;
+            }
+            
+            child->OutputFd = captureOutput ? outputPipe[0] : -1;
+            child->PidFd = OpenPidFd(child->Pid);
+            if(child->PidFd < 0)
+                InstallChildSignalHandler();
+            
+            child->CancelFlag = cancelFlag;
+            if(captureOutput)
+                child->Output.resize(64 * 1024);
+            
+            {
+                std::unique_lock<std::mutex> lock(ChildrenMutex);
+                NewChildren.push_back(std::move(child));
+                if(!EventThread.joinable())
+                    EventThread = std::thread([this]() { EventLoop(); });
+            }
+            
+            Wake();
+        }
+    
+    private:
+        struct Child
+        {
+            pid_t Pid = -1;
+            int OutputFd = -1;
+            int PidFd = -1;
+            std::vector<char> Output;
+            std::size_t OutputSize = 0;
+            const std::atomic<bool>* CancelFlag = nullptr;
+            bool Terminated = false;
+            std::function<void(SubprocessResult)> OnFinished;
+        };
+        
+        inline SubprocessManager()
+        {
+            if(pipe2(WakePipe, O_CLOEXEC | O_NONBLOCK) != 0)
+            {
+                WakePipe[0] = -1;
+                WakePipe[1] = -1;
+            }
+        }
+        
+        inline ~SubprocessManager()
+        {
+            {
+                std::unique_lock<std::mutex> lock(ChildrenMutex);
+                Stopping = true;
+            }
+            
+            Wake();
+            if(EventThread.joinable())
+                EventThread.join();
+            
+            if(WakePipe[0] >= 0)
+            {
+                GetChildSignalWakeFd() = -1;
+                close(WakePipe[0]);
+                close(WakePipe[1]);
+            }
+        }
+        
+        inline static std::string QuoteForShell(const std::string& value)
+        {
+            std::string quoted = "'";
+            for(int i = 0; i < value.size(); ++i)
+            {
+                if(value[i] == '\'')
+                    quoted += "'\\''";
+                else
+                    quoted += value[i];
+            }
+            return quoted + "'";
+        }
+        
+        //NOTE: Returns -1 if pidfd_open is not supported, which needs Linux 5.3
+        inline static int OpenPidFd(pid_t pid)
+        {
+            #if defined(SYS_pidfd_open)
+                return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+            #else
+                (void)pid;
+                return -1;
+            #endif
+        }
+        
+        inline static int& GetChildSignalWakeFd()
+        {
+            static int wakeFd = -1;
+            return wakeFd;
+        }
+        
+        inline static struct sigaction& GetPreviousChildSignalAction()
+        {
+            static struct sigaction previousAction;
+            return previousAction;
+        }
+        
+        inline static void OnChildSignal(int signalNumber, siginfo_t* info, void* context)
+        {
+            const int savedErrno = errno;
+            const int wakeFd = GetChildSignalWakeFd();
+            if(wakeFd >= 0)
+            {
+                //The wake pipe being full is fine, the thread is waking up already
+                char wakeByte = 0;
+                ssize_t writeResult = write(wakeFd, &wakeByte, 1);
+                (void)writeResult;
+            }
+            errno = savedErrno;
+            
+            const struct sigaction& previousAction = GetPreviousChildSignalAction();
+            if(previousAction.sa_flags & SA_SIGINFO)
+            {
+                if(previousAction.sa_sigaction)
+                    previousAction.sa_sigaction(signalNumber, info, context);
+            }
+            else if(previousAction.sa_handler != SIG_DFL && previousAction.sa_handler != SIG_IGN)
+                previousAction.sa_handler(signalNumber);
+        }
+        
+        //NOTE: Only used when a pidfd can't be opened for a child. The handler wakes the waiting 
+        //      thread for any child exiting, and calls the handler that was installed before.
+        inline void InstallChildSignalHandler()
+        {
+            std::unique_lock<std::mutex> lock(ChildrenMutex);
+            if(ChildSignalHandlerInstalled)
+                return;
+            
+            ChildSignalHandlerInstalled = true;
+            GetChildSignalWakeFd() = WakePipe[1];
+            
+            struct sigaction action;
+            memset(&action, 0, sizeof(action));
+            action.sa_sigaction = &OnChildSignal;
+            action.sa_flags = SA_SIGINFO | SA_RESTART | SA_NOCLDSTOP;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGCHLD, &action, &GetPreviousChildSignalAction());
+        }
+        
+        inline void ReadOutput(Child& child)
+        {
+            while(true)
+            {
+                if(child.Output.size() - child.OutputSize < 4096)
+                    child.Output.resize(child.Output.size() * 2);
+                
+                ssize_t bytesRead = read(   child.OutputFd,
+                                            child.Output.data() + child.OutputSize,
+                                            child.Output.size() - child.OutputSize);
+                if(bytesRead > 0)
+                {
+                    child.OutputSize += bytesRead;
+                    
+                    //Don't hold up other children if there's a lot of output
+                    return;
+                }
+                
+                if(bytesRead < 0 && errno == EINTR)
+                    continue;
+                
+                //End of output or error, the child is reaped when it exits
+                if(bytesRead == 0 || errno != EAGAIN)
+                {
+                    close(child.OutputFd);
+                    child.OutputFd = -1;
+                }
+                return;
+            }
+        }
+        
+        //NOTE: Returns true if the child has exited and the result is set
+        inline bool TryReap(Child& child)
+        {
+            int status = 0;
+            struct rusage usage;
+            pid_t waitResult = wait4(child.Pid, &status, WNOHANG, &usage);
+            if(waitResult == 0 || (waitResult < 0 && errno == EINTR))
+                return false;
+            
+            SubprocessResult result;
+            result.Started = waitResult == child.Pid;
+            if(result.Started)
+            {
+                if(WIFEXITED(status))
+                    result.ReturnCode = WEXITSTATUS(status);
+                else if(WIFSIGNALED(status))
+                    result.ReturnCode = 128 + WTERMSIG(status);
+                
+                result.PeakMemoryKB = static_cast<int64_t>(usage.ru_maxrss);
+            }
+            
+            if(child.PidFd >= 0)
+            {
+                close(child.PidFd);
+                child.PidFd = -1;
+            }
+            
+            result.Output.assign(child.Output.data(), child.OutputSize);
+            child.OnFinished(std::move(result));
+            return true;
+        }
+        
+        inline void EventLoop()
+        {
+            std::vector<std::unique_ptr<Child>> children;
+            std::vector<struct pollfd> pollFds;
+            
+            while(true)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(ChildrenMutex);
+                    for(int i = 0; i < NewChildren.size(); ++i)
+                        children.push_back(std::move(NewChildren.at(i)));
+                    NewChildren.clear();
+                    
+                    if(Stopping && children.empty())
+                        return;
+                }
+                
+                //Terminate the children that are cancelled, including the processes started by them
+                for(int i = 0; i < children.size(); ++i)
+                {
+                    Child& child = *children.at(i);
+                    if(!child.CancelFlag || child.Terminated)
+                        continue;
+                    
+                    if(child.CancelFlag->load())
+                    {
+                        kill(-child.Pid, SIGTERM);
+                        child.Terminated = true;
+                    }
+                }
+                
+                //Reap the children that have finished outputting
+                for(int i = children.size() - 1; i >= 0; --i)
+                {
+                    if(children.at(i)->OutputFd >= 0)
+                        continue;
+                    
+                    if(TryReap(*children.at(i)))
+                        children.erase(children.begin() + i);
+                }
+                
+                //The pidfds of the children still outputting are not polled, since they stay 
+                //readable after exiting until the output is read and they are reaped
+                pollFds.clear();
+                pollFds.push_back({ WakePipe[0], POLLIN, 0 });
+                for(int i = 0; i < children.size(); ++i)
+                {
+                    if(children.at(i)->OutputFd >= 0)
+                        pollFds.push_back({ children.at(i)->OutputFd, POLLIN, 0 });
+                    else if(children.at(i)->PidFd >= 0)
+                        pollFds.push_back({ children.at(i)->PidFd, POLLIN, 0 });
+                }
+                
+                int pollResult = poll(pollFds.data(), pollFds.size(), -1);
+                if(pollResult <= 0)
+                    continue;
+                
+                if(pollFds.at(0).revents & POLLIN)
+                {
+                    char wakeBytes[64];
+                    while(read(WakePipe[0], wakeBytes, sizeof(wakeBytes)) > 0);
+                }
+                
+                //The exited children are reaped at the start of the next loop
+                int pollIndex = 1;
+                for(int i = 0; i < children.size(); ++i)
+                {
+                    if(children.at(i)->OutputFd < 0)
+                    {
+                        if(children.at(i)->PidFd >= 0)
+                            ++pollIndex;
+                        continue;
+                    }
+                    
+                    if(pollFds.at(pollIndex).revents & (POLLIN | POLLHUP | POLLERR))
+                        ReadOutput(*children.at(i));
+                    ++pollIndex;
+                }
+            }
+        }
+        
+        int WakePipe[2] = { -1, -1 };
+        std::mutex ChildrenMutex;
+        std::vector<std::unique_ptr<Child>> NewChildren;
+        std::thread EventThread;
+        bool Stopping = false;
+        bool ChildSignalHandlerInstalled = false;
+    };
+#endif
+}
+
+#endif
@@ -3,6 +3,8 @@
 #include "runcpp2/Data/ScriptInfo.hpp"
 
 #include "runcpp2/ConfigParsing.hpp"
+#include "runcpp2/FileWatcher.hpp"
+#include "runcpp2/HotReloadHost.hpp"
 #include "runcpp2/StringUtil.hpp"
 #include "runcpp2/runcpp2.hpp"
 
@@ -12,6 +14,7 @@
 
 //NOTE: #include "runcpp2/DefaultYAMLs.c" at the end
 
+#include <algorithm>
 #include <cctype>
 #include <chrono>
 #include <fstream>
@@ -216,7 +219,19 @@ void PrintRunBuildWatchCommonOptions(bool includeSourceOnly)
                 "build config");
     
     ssLOG_BASE( PadSpaceRight("  -j,  --[j]obs <number>", CMD_COLS_BEFORE_DESC) +
-                "Maximum number of threads running. Defaults to 8");
+                "Maximum number of threads running.\n" +
+                PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                "Defaults to number of hardware threads minus current system load");
+    ssLOG_BASE( PadSpaceRight("  -m,  --[m]emory-limit <MB>", CMD_COLS_BEFORE_DESC) +
+                "Limits the estimated memory used by compiling in parallel.\n" +
+                PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                "Estimates are based on previous compilations. Defaults to no limit");
+    ssLOG_BASE( PadSpaceRight("  -ff, --[f]ail-[f]ast", CMD_COLS_BEFORE_DESC) +
+                "Stops compiling and terminates running compilers on the first error.\n" +
+                PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                "Only the first error is reported. Defaults to on for watch");
+    ssLOG_BASE( PadSpaceRight("  -nff, --[n]o-[f]ail-[f]ast", CMD_COLS_BEFORE_DESC) +
+                "Compiles all source files even if some of them failed");
     ssLOG_BASE( PadSpaceRight("  -c,  --[c]onfig <file>", CMD_COLS_BEFORE_DESC) +
                 "Use specified config file instead of default");
 }
@@ -230,6 +245,8 @@ DS::Result<bool> ExtractRunBuildWatchOptions(   int argc,
                                                 bool& outSourceOnly,
                                                 std::string& outParams,
                                                 std::string& outJobs,
+                                                std::string& outMemoryLimit,
+                                                bool& outFailFast,
                                                 std::string& outConfigPath)
 {
     if(strcmp(argv[argIndex], "-l") == 0 || strcmp(argv[argIndex], "--local") == 0)
@@ -251,6 +268,16 @@ DS::Result<bool> ExtractRunBuildWatchOptions(   int argc,
             return DS_ERROR_MSG("Expecting value after -j or --jobs");
         outJobs = argv[++argIndex];
     }
+    else if(strcmp(argv[argIndex], "-m") == 0 || strcmp(argv[argIndex], "--memory-limit") == 0)
+    {
+        if(argIndex == argc - 1)
+            return DS_ERROR_MSG("Expecting value after -m or --memory-limit");
+        outMemoryLimit = argv[++argIndex];
+    }
+    else if(strcmp(argv[argIndex], "-ff") == 0 || strcmp(argv[argIndex], "--fail-fast") == 0)
+        outFailFast = true;
+    else if(strcmp(argv[argIndex], "-nff") == 0 || strcmp(argv[argIndex], "--no-fail-fast") == 0)
+        outFailFast = false;
     else if(strcmp(argv[argIndex], "-c") == 0 || strcmp(argv[argIndex], "--config") == 0)
     {
         if(argIndex == argc - 1)
@@ -263,6 +290,122 @@ DS::Result<bool> ExtractRunBuildWatchOptions(   int argc,
     return true;
 }
 
+//NOTE: Builds the script as a shared library and keeps calling its update function. The changes 
+//      are checked between the updates, and the library is rebuilt and reloaded if needed.
+DS::Result<int> RunHotReload(   runcpp2::CoreParams& coreParams,
+                                bool sourceOnly,
+                                bool failFast,
+                                const std::vector<std::string>& scriptArgs,
+                                const std::string& jobs,
+                                const std::string& memoryLimit)
+{
+    runcpp2::Data::ScriptInfo* lastParsedScriptInfo = nullptr;
+    runcpp2::Data::ScriptInfo parsedScriptInfo;
+    ghc::filesystem::file_time_type lastFinalSourceWriteTime;
+    ghc::filesystem::file_time_type lastFinalIncludeWriteTime;
+    runcpp2::HotReloadHost hotReloadHost;
+    
+    //Check for changes with inotify if possible, otherwise check for changes every 5 seconds
+    runcpp2::FileWatcher fileWatcher;
+    bool useFileWatcher = runcpp2::FileWatcher::IsSupported();
+    std::chrono::steady_clock::time_point lastCheckTime = std::chrono::steady_clock::now();
+    bool needsBuilding = true;
+    
+    while(true)
+    {
+        if(needsBuilding)
+        {
+            needsBuilding = false;
+            ghc::filesystem::path libraryPath;
+            runcpp2::RunParams runParams 
+            { 
+                coreParams, 
+                false, 
+                false, 
+                sourceOnly, 
+                true, 
+                failFast,
+                true,
+                scriptArgs, 
+                jobs, 
+                memoryLimit,
+                lastParsedScriptInfo,
+                "",
+                nullptr,
+                nullptr
+            };
+            
+            DS::Result<int> buildResult = runcpp2::Run( runParams,
+                                                        //Outputs
+                                                        parsedScriptInfo,
+                                                        lastFinalSourceWriteTime,
+                                                        lastFinalIncludeWriteTime,
+                                                        &libraryPath);
+            
+            //Keep running the loaded library if the changes failed to build or load
+            if(!buildResult.HasValue() && !hotReloadHost.IsLoaded())
+                buildResult.DS_TRY();
+            else if(!buildResult.HasValue())
+                ssLOG_ERROR(buildResult.Error().ToString());
+            else
+            {
+                lastParsedScriptInfo = &parsedScriptInfo;
+                DS::Result<void> loadResult = hotReloadHost.Load(libraryPath, scriptArgs);
+                if(!loadResult.HasValue() && !hotReloadHost.IsLoaded())
+                    loadResult.DS_TRY();
+                else if(!loadResult.HasValue())
+                    ssLOG_ERROR(loadResult.Error().ToString());
+            }
+            
+            if(useFileWatcher)
+            {
+                std::vector<ghc::filesystem::path> watchFilesPaths;
+                std::vector<ghc::filesystem::path> watchDirectoriesPaths;
+                runcpp2::GetWatchPaths( coreParams, 
+                                        jobs, 
+                                        watchFilesPaths, 
+                                        watchDirectoriesPaths).DS_TRY();
+                
+                if(!fileWatcher.SetWatchPaths(watchFilesPaths, watchDirectoriesPaths))
+                {
+                    ssLOG_WARNING("Failed to watch for changes, checking for changes periodically");
+                    useFileWatcher = false;
+                }
+            }
+        }
+        
+        if(!hotReloadHost.RunUpdate())
+            break;
+        
+        //Only check for changes between the updates, so that the library is never reloaded 
+        //while it is running
+        if(useFileWatcher)
+        {
+            if(!fileWatcher.CheckForChanges(50, needsBuilding))
+            {
+                ssLOG_WARNING("Failed to check for changes, checking for changes periodically");
+                useFileWatcher = false;
+            }
+        }
+        else if(std::chrono::steady_clock::now() - lastCheckTime >= std::chrono::seconds(5))
+        {
+            lastCheckTime = std::chrono::steady_clock::now();
+            needsBuilding = runcpp2::CheckSourcesNeedUpdate(coreParams,
+                                                            jobs,
+                                                            true,
+                                                            lastParsedScriptInfo,
+                                                            lastFinalSourceWriteTime,
+                                                            lastFinalIncludeWriteTime).DS_TRY();
+        }
+        
+        if(needsBuilding)
+            ssLOG_INFO("Source files have changed, reloading...");
+    }
+    
+    hotReloadHost.Unload(false);
+    return 0;
+}
+
 DS::Result<int> HandleRun(int argc, char* argv[])
 {
     //runcpp2 run <...>
@@ -272,6 +415,14 @@ DS::Result<int> HandleRun(int argc, char* argv[])
         ssLOG_BASE("Options:");
         
         PrintRunBuildWatchCommonOptions(true);
+        ssLOG_BASE( PadSpaceRight("  -ht, --[h]o[t]", CMD_COLS_BEFORE_DESC) + 
+                    "Builds the script as a shared library and loads it into runcpp2.\n" +
+                    PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                    "The library is rebuilt and reloaded when the source files change.\n" +
+                    PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                    "The script needs to export Runcpp2HotLoad, Runcpp2HotUpdate and\n" +
+                    PadSpaceRight("", CMD_COLS_BEFORE_DESC) + 
+                    "optionally Runcpp2HotUnload");
         PrintGeneralOptions();
         
         return 0;
@@ -282,7 +433,10 @@ DS::Result<int> HandleRun(int argc, char* argv[])
     std::string params = "";
     int argIndex;
     std::string jobs = "";
+    std::string memoryLimit = "";
+    bool failFast = false;
     std::string configPath = "";
+    bool hot = false;
     for(argIndex = 2; argIndex < argc; ++argIndex)
     {
         bool parsed = ExtractRunBuildWatchOptions(  argc, 
@@ -293,12 +447,19 @@ DS::Result<int> HandleRun(int argc, char* argv[])
                                                     sourceOnly,
                                                     params,
                                                     jobs,
+                                                    memoryLimit,
+                                                    failFast,
                                                     configPath).DS_TRY();
         if(!parsed)
         {
-            parsed = ProcessGeneralOptions(argc, argv, argIndex).DS_TRY();
-            if(!parsed)
-                break;
+            if(strcmp(argv[argIndex], "-ht") == 0 || strcmp(argv[argIndex], "--hot") == 0)
+                hot = true;
+            else
+            {
+                parsed = ProcessGeneralOptions(argc, argv, argIndex).DS_TRY();
+                if(!parsed)
+                    break;
+            }
         }
     }
     
@@ -321,6 +482,12 @@ DS::Result<int> HandleRun(int argc, char* argv[])
     for(int i = 0; i < profiles.size(); ++i)
         ssLOG_DEBUG("\n" << profiles.at(i).ToString("    "));
     
+    if(hot)
+    {
+        runcpp2::CoreParams coreParams = { script, profiles, params, local, preferredProfile };
+        return RunHotReload(coreParams, sourceOnly, failFast, scriptArgs, jobs, memoryLimit);
+    }
+    
     runcpp2::Data::ScriptInfo parsedScriptInfo;
     ghc::filesystem::file_time_type finalSourceWriteTime;
     ghc::filesystem::file_time_type finalIncludeWriteTime;
@@ -336,10 +503,15 @@ DS::Result<int> HandleRun(int argc, char* argv[])
                                         false, 
                                         sourceOnly, 
                                         false, 
+                                        failFast,
+                                        false,
                                         scriptArgs, 
                                         jobs, 
+                                        memoryLimit,
+                                        nullptr,
+                                        "",
                                         nullptr,
-                                        ""
+                                        nullptr
                                     };
     int result = runcpp2::Run(  runParams,
                                 //Outputs
@@ -370,6 +542,8 @@ DS::Result<void> HandleBuild(int argc, char* argv[])
     std::string params = "";
     int argIndex;
     std::string jobs = "";
+    std::string memoryLimit = "";
+    bool failFast = false;
     std::string configPath = "";
     bool rebuild = false;
     ghc::filesystem::path outputDir = "";
@@ -383,6 +557,8 @@ DS::Result<void> HandleBuild(int argc, char* argv[])
                                                     sourceOnly,
                                                     params,
                                                     jobs,
+                                                    memoryLimit,
+                                                    failFast,
                                                     configPath).DS_TRY();
         if(!parsed)
         {
@@ -430,10 +606,15 @@ DS::Result<void> HandleBuild(int argc, char* argv[])
                                         false, 
                                         sourceOnly, 
                                         true, 
+                                        failFast,
+                                        false,
                                         {}, 
                                         jobs, 
+                                        memoryLimit,
+                                        nullptr,
+                                        outputDir,
                                         nullptr,
-                                        outputDir
+                                        nullptr
                                     };
     runcpp2::Run(   runParams,
                     //Outputs
@@ -444,12 +625,69 @@ DS::Result<void> HandleBuild(int argc, char* argv[])
     return {};
 }
 
+struct WatchedScript
+{
+    ghc::filesystem::path Path;
+    runcpp2::Data::ScriptInfo ParsedScriptInfo;
+    runcpp2::Data::ScriptInfo* LastParsedScriptInfo = nullptr;
+    ghc::filesystem::file_time_type LastFinalSourceWriteTime;
+    ghc::filesystem::file_time_type LastFinalIncludeWriteTime;
+    bool NeedsRunning = true;
+};
+
+//NOTE: If inputPath is a directory, all the files in it with the file extensions of any profiles
+//      are added as scripts
+DS::Result<void> GatherWatchScripts(const ghc::filesystem::path& inputPath,
+                                    const std::vector<runcpp2::Data::Profile>& profiles,
+                                    std::vector<WatchedScript>& outScripts)
+{
+    std::error_code e;
+    if(!ghc::filesystem::is_directory(inputPath, e))
+    {
+        outScripts.emplace_back();
+        outScripts.back().Path = inputPath;
+        return {};
+    }
+    
+    std::vector<ghc::filesystem::path> scriptsPaths;
+    for(ghc::filesystem::directory_iterator it(inputPath, e); 
+        !e && it != ghc::filesystem::directory_iterator(); 
+        it.increment(e))
+    {
+        if(!it->is_regular_file(e))
+            continue;
+        
+        const std::string extension = it->path().extension().string();
+        for(int i = 0; i < profiles.size(); ++i)
+        {
+            if(profiles.at(i).FileExtensions.count(extension) > 0)
+            {
+                scriptsPaths.push_back(it->path());
+                break;
+            }
+        }
+    }
+    
+    if(e)
+        return DS_ERROR_MSG("Failed to read directory " + inputPath.string() + ": " + e.message());
+    
+    //Keep the order stable between runs
+    std::sort(scriptsPaths.begin(), scriptsPaths.end());
+    for(int i = 0; i < scriptsPaths.size(); ++i)
+    {
+        outScripts.emplace_back();
+        outScripts.back().Path = scriptsPaths.at(i);
+    }
+    
+    return {};
+}
+
 DS::Result<void> HandleWatch(int argc, char* argv[])
 {
-    //runcpp2 watch <input file>
+    //runcpp2 watch <input files or directories>
     if(argc <= 2 || strcmp(argv[2], "--help") == 0 || strcmp(argv[2], "-h") == 0)
     {
-        ssLOG_BASE("Usage: runcpp2 watch [options] <input file>");
+        ssLOG_BASE("Usage: runcpp2 watch [options] <input files or directories>");
         ssLOG_BASE("Options:");
         PrintRunBuildWatchCommonOptions(true);
         PrintGeneralOptions();
@@ -461,6 +699,8 @@ DS::Result<void> HandleWatch(int argc, char* argv[])
     std::string params = "";
     int argIndex;
     std::string jobs = "";
+    std::string memoryLimit = "";
+    bool failFast = true;
     std::string configPath = "";
     for(argIndex = 2; argIndex < argc; ++argIndex)
     {
@@ -472,16 +712,21 @@ DS::Result<void> HandleWatch(int argc, char* argv[])
                                                     sourceOnly,
                                                     params,
                                                     jobs,
+                                                    memoryLimit,
+                                                    failFast,
                                                     configPath).DS_TRY();
-        parsed = ProcessGeneralOptions(argc, argv, argIndex).DS_TRY();
         if(!parsed)
-            break;
+        {
+            parsed = ProcessGeneralOptions(argc, argv, argIndex).DS_TRY();
+            if(!parsed)
+                break;
+        }
     }
     
     if(argIndex >= argc)
         return DS_ERROR_MSG("Input file expected");
-    ghc::filesystem::path script = argv[argIndex++];
     
+    //The profiles are parsed once and shared by all the scripts
     std::vector<runcpp2::Data::Profile> profiles;
     std::string preferredProfile;
     runcpp2::ReadUserConfig(profiles, preferredProfile, params, configPath).DS_TRY();
@@ -490,28 +735,92 @@ DS::Result<void> HandleWatch(int argc, char* argv[])
     for(int i = 0; i < profiles.size(); ++i)
         ssLOG_DEBUG("\n" << profiles.at(i).ToString("    "));
     
-    runcpp2::Data::ScriptInfo* lastParsedScriptInfo = nullptr;
-    runcpp2::Data::ScriptInfo parsedScriptInfo;
-    ghc::filesystem::file_time_type lastFinalSourceWriteTime;
-    ghc::filesystem::file_time_type lastFinalIncludeWriteTime;
-    bool needsRunning = true;  //First run always needs running
+    std::vector<WatchedScript> scripts;
+    for(; argIndex < argc; ++argIndex)
+        GatherWatchScripts(argv[argIndex], profiles, scripts).DS_TRY();
+    
+    if(scripts.empty())
+        return DS_ERROR_MSG("No script files found to watch");
+    
+    const int maxThreads =  jobs.empty() ? 
+                            runcpp2::GetDefaultMaxThreads() : 
+                            strtol(jobs.c_str(), nullptr, 10);
+    if(maxThreads <= 0)
+        return DS_ERROR_MSG("Invalid number of threads passed in");
+    
+    const int64_t memoryLimitMB =   memoryLimit.empty() ? 
+                                    0 : 
+                                    strtoll(memoryLimit.c_str(), nullptr, 10);
+    if(memoryLimitMB < 0 || (!memoryLimit.empty() && memoryLimitMB == 0))
+        return DS_ERROR_MSG("Invalid memory limit passed in");
+    
+    //The workers and the information of the files are shared by all the scripts, so that 
+    //the include records and the files used by multiple scripts are only checked once each time
+    runcpp2::Jobserver jobserver;
+    jobserver.Initialize(maxThreads);
+    runcpp2::JobPool jobPool(maxThreads, memoryLimitMB * 1024, &jobserver);
+    runcpp2::FilesCache filesCache;
+    
+    //Wait for changes with inotify if possible, otherwise check for changes every 5 seconds
+    runcpp2::FileWatcher fileWatcher;
+    bool useFileWatcher = runcpp2::FileWatcher::IsSupported();
+    bool firstRun = true;   //First run always needs running
     
-    runcpp2::CoreParams coreParams = { script, profiles, params, local, preferredProfile };
     while(true)
     {
-        //Check if sources need update
-        bool needsUpdate = false;
-        if(!needsRunning)   //Skip check on first run
+        //Check which scripts need update
+        bool needsRunning = firstRun;
+        if(!firstRun && useFileWatcher)
         {
-            needsRunning = runcpp2::CheckSourcesNeedUpdate( coreParams,
-                                                            jobs,
-                                                            lastParsedScriptInfo,
-                                                            lastFinalSourceWriteTime,
-                                                            lastFinalIncludeWriteTime).DS_TRY();
-            if(needsUpdate)
+            //Wait for editors to finish writing before rebuilding
+            std::vector<int> changedScripts;
+            if(fileWatcher.WaitForChanges(50, changedScripts))
+            {
+                for(int i = 0; i < changedScripts.size(); ++i)
+                {
+                    ssLOG_INFO("Source files have changed for " << 
+                               scripts.at(changedScripts.at(i)).Path.string());
+                    scripts.at(changedScripts.at(i)).NeedsRunning = true;
+                }
+                needsRunning = !changedScripts.empty();
+            }
+            else
+            {
+                ssLOG_WARNING("Failed to wait for changes, checking for changes periodically");
+                useFileWatcher = false;
+            }
+        }
+        
+        //The files might have changed since the last time they were checked
+        filesCache.ClearWriteTimes();
+        
+        if(!firstRun && !useFileWatcher)
+        {
+            for(int i = 0; i < scripts.size(); ++i)
             {
-                ssLOG_INFO("Source files have changed");
-                needsRunning = true;
+                WatchedScript& script = scripts.at(i);
+                runcpp2::CoreParams coreParams = 
+                {
+                    script.Path, 
+                    profiles, 
+                    params, 
+                    local, 
+                    preferredProfile 
+                };
+                script.NeedsRunning = 
+                    runcpp2::CheckSourcesNeedUpdate(coreParams,
+                                                    jobs,
+                                                    false,
+                                                    script.LastParsedScriptInfo,
+                                                    script.LastFinalSourceWriteTime,
+                                                    script.LastFinalIncludeWriteTime,
+                                                    &jobPool,
+                                                    &filesCache).DS_TRY();
+                if(script.NeedsRunning)
+                {
+                    ssLOG_INFO("Source files have changed for " << script.Path.string());
+                    needsRunning = true;
+                }
             }
         }
         
@@ -528,40 +837,86 @@ DS::Result<void> HandleWatch(int argc, char* argv[])
                 #endif
             }
             
-            ssLOG_LINE("Changes detected, running...");
-            runcpp2::RunParams runParams 
-            { 
-                coreParams, 
-                false, 
-                true, 
-                sourceOnly, 
-                true, 
-                {}, 
-                jobs, 
-                lastParsedScriptInfo,
-                ""
-            };
-            runcpp2::Run(   runParams,
-                            //Outputs
-                            parsedScriptInfo,
-                            lastFinalSourceWriteTime,
-                            lastFinalIncludeWriteTime)
-                .DS_TRY_ACT
-                (
-                    //Unexpected errors
-                    if( DS_TMP_ERROR.Message.find("CompileScript failed") == std::string::npos &&
-                        DS_TMP_ERROR.Message.find("LinkScript failed") == std::string::npos)
+            //Only rebuild the scripts affected by the changes
+            for(int i = 0; i < scripts.size(); ++i)
+            {
+                WatchedScript& script = scripts.at(i);
+                if(!script.NeedsRunning)
+                    continue;
+                
+                ssLOG_LINE("Changes detected, running " << script.Path.string() << "...");
+                runcpp2::CoreParams coreParams = 
+                {
+                    script.Path, 
+                    profiles, 
+                    params, 
+                    local, 
+                    preferredProfile 
+                };
+                runcpp2::RunParams runParams 
+                { 
+                    coreParams, 
+                    false, 
+                    true, 
+                    sourceOnly, 
+                    true, 
+                    failFast,
+                    false,
+                    {}, 
+                    jobs, 
+                    memoryLimit,
+                    script.LastParsedScriptInfo,
+                    "",
+                    &jobPool,
+                    &filesCache
+                };
+                runcpp2::Run(   runParams,
+                                //Outputs
+                                script.ParsedScriptInfo,
+                                script.LastFinalSourceWriteTime,
+                                script.LastFinalIncludeWriteTime)
+                    .DS_TRY_ACT
+                    (
+                        //Unexpected errors
+                        if( DS_TMP_ERROR.Message.find("CompileScript failed") == 
+                                std::string::npos &&
+                            DS_TMP_ERROR.Message.find("LinkScript failed") == std::string::npos)
+                        {
+                            return DS::Error(DS_APPEND_TRACE(DS_TMP_ERROR));
+                        }
+                    );
+                
+                script.LastParsedScriptInfo = &script.ParsedScriptInfo;
+                script.NeedsRunning = false;
+                
+                //NOTE: The watched paths can change after each run, such as the includes. 
+                //      Only the paths of this script are updated, with the script index as the 
+                //      group, so that the watches of the other scripts are kept as they are.
+                if(useFileWatcher)
+                {
+                    std::vector<ghc::filesystem::path> watchFilesPaths;
+                    std::vector<ghc::filesystem::path> watchDirectoriesPaths;
+                    runcpp2::GetWatchPaths( coreParams, 
+                                            jobs, 
+                                            watchFilesPaths, 
+                                            watchDirectoriesPaths,
+                                            &filesCache).DS_TRY();
+                    
+                    if(!fileWatcher.SetWatchPaths(watchFilesPaths, watchDirectoriesPaths, i))
                     {
-                        return DS::Error(DS_APPEND_TRACE(DS_TMP_ERROR));
+                        ssLOG_WARNING(  "Failed to watch for changes, " << 
+                                        "checking for changes periodically");
+                        useFileWatcher = false;
                     }
-                );
+                }
+            }
             
-            lastParsedScriptInfo = &parsedScriptInfo;
-            needsRunning = false;
+            firstRun = false;
             ssLOG_BASE("Watching...");
         } //if(needsRunning)
         
-        std::this_thread::sleep_for(std::chrono::seconds(5));
+        if(!useFileWatcher)
+            std::this_thread::sleep_for(std::chrono::seconds(5));
     }
     
     return {};
@@ -642,6 +997,8 @@ DS::Result<void> HandleReset(int argc, char* argv[])
     std::string params = "";
     int argIndex;
     std::string jobs = "";
+    std::string memoryLimit = "";
+    bool failFast = false;
     std::string configPath = "";
     std::string deps = "all";
     bool depsOnly = false;
@@ -655,6 +1012,8 @@ DS::Result<void> HandleReset(int argc, char* argv[])
                                                     sourceOnly,
                                                     params,
                                                     jobs,
+                                                    memoryLimit,
+                                                    failFast,
                                                     configPath).DS_TRY();
         if(!parsed)
         {
@@ -697,6 +1056,62 @@ DS::Result<void> HandleReset(int argc, char* argv[])
     return {};
 }
 
+DS::Result<void> HandleLock(int argc, char* argv[])
+{
+    //runcpp2 lock [options] <input file>
+    if(argc <= 2 || strcmp(argv[2], "--help") == 0 || strcmp(argv[2], "-h") == 0)
+    {
+        ssLOG_BASE("Usage: runcpp2 lock [options] <input file>");
+        ssLOG_BASE("Options:");
+        PrintRunBuildWatchCommonOptions(false);
+        PrintGeneralOptions();
+        return {};
+    }
+    
+    bool local = false;
+    bool sourceOnly = false;
+    std::string params = "";
+    int argIndex;
+    std::string jobs = "";
+    std::string memoryLimit = "";
+    bool failFast = false;
+    std::string configPath = "";
+    for(argIndex = 2; argIndex < argc; ++argIndex)
+    {
+        bool parsed = ExtractRunBuildWatchOptions(  argc, 
+                                                    argv, 
+                                                    argIndex, 
+                                                    false,
+                                                    local, 
+                                                    sourceOnly,
+                                                    params,
+                                                    jobs,
+                                                    memoryLimit,
+                                                    failFast,
+                                                    configPath).DS_TRY();
+        if(!parsed)
+        {
+            parsed = ProcessGeneralOptions(argc, argv, argIndex).DS_TRY();
+            if(!parsed)
+                break;
+        }
+    }
+    
+    if(argIndex >= argc)
+        return DS_ERROR_MSG("Input file expected");
+    ghc::filesystem::path script = argv[argIndex++];
+    
+    std::vector<runcpp2::Data::Profile> profiles;
+    std::string preferredProfile;
+    runcpp2::ReadUserConfig(profiles, preferredProfile, params, configPath).DS_TRY();
+    
+    runcpp2::CoreParams coreParams = { script, profiles, params, local, preferredProfile };
+    runcpp2::RunRefreshDependenciesLock(coreParams).DS_TRY();
+    
+    ssLOG_BASE("Lockfile updated");
+    return {};
+}
+
 DS::Result<int> Main(int argc, char* argv[])
 {
     INTERNAL_RUNCPP2_SAFE_START()
@@ -721,6 +1136,8 @@ DS::Result<int> Main(int argc, char* argv[])
                     "Replace current user config with the default one");
         ssLOG_BASE( PadSpaceRight("    reset", CMD_COLS_BEFORE_DESC) +
                     "Perform cleanup on both/either the source and/or the dependencies");
+        ssLOG_BASE( PadSpaceRight("    lock", CMD_COLS_BEFORE_DESC) +
+                    "Update the dependencies lockfile with the latest revisions");
         ssLOG_BASE( PadSpaceRight("    show-config-path", CMD_COLS_BEFORE_DESC) + 
                     "Show where runcpp2 is reading the config from");
         ssLOG_BASE(PadSpaceRight("    version", CMD_COLS_BEFORE_DESC) + "Show the version of runcpp2");
@@ -754,6 +1171,10 @@ DS::Result<int> Main(int argc, char* argv[])
     {
         HandleReset(argc, argv).DS_TRY();
     }
+    else if(strcmp(argv[1], "lock") == 0)
+    {
+        HandleLock(argc, argv).DS_TRY();
+    }
     else if(strcmp(argv[1], "show-config-path") == 0)
     {
         ghc::filesystem::path configFilePath = runcpp2::GetConfigFilePath().DS_TRY();
@@ -15,18 +15,25 @@
 #include "runcpp2/PlatformUtil.hpp"
 #include "runcpp2/BuildsManager.hpp"
 #include "runcpp2/IncludeManager.hpp"
+#include "runcpp2/FilesCache.hpp"
+#include "runcpp2/JobPool.hpp"
+#include "runcpp2/Jobserver.hpp"
 
 #include "ssLogger/ssLog.hpp"
 #include "ghc/filesystem.hpp"
 #include "DSResult/DSResult.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <chrono>
+#include <future>
+#include <memory>
 #include <stdint.h>
 #include <stdlib.h>
 #include <system_error>
 #include <unordered_map>
+#include <unordered_set>
 
 //NOTE: #include "runcpp2/LibYamlImpl.cpp" at the end
 
@@ -78,7 +85,7 @@ namespace
         for(int i = 0; i < sourceFiles.size(); ++i)
         {
             ghc::filesystem::path relativeSourcePath = 
-                ghc::filesystem::relative(sourceFiles.at(i), scriptDirectory, e);
+                runcpp2::GetSourceRelativePath(sourceFiles.at(i), scriptDirectory, buildDir, e);
             
             if(e)
             {
@@ -97,7 +104,7 @@ namespace
             
             //Check source file timestamp
             ghc::filesystem::file_time_type currentSourceWriteTime = 
-                ghc::filesystem::last_write_time(sourceFiles.at(i), e);
+                includeManager.GetWriteTime(sourceFiles.at(i));
             if(currentSourceWriteTime > outFinalSourceWriteTime)
                 outFinalSourceWriteTime = currentSourceWriteTime;
 
@@ -120,7 +127,7 @@ namespace
                 for(int j = 0; j < cachedIncludes.size(); ++j)
                 {
                     ghc::filesystem::file_time_type includeWriteTime = 
-                        ghc::filesystem::last_write_time(cachedIncludes.at(j), e);
+                        includeManager.GetWriteTime(cachedIncludes.at(j));
                     
                     if(includeWriteTime > currentIncludeWriteTime)
                         currentIncludeWriteTime = includeWriteTime;
@@ -439,12 +446,68 @@ namespace runcpp2
         return {};
     }
 
+    inline DS::Result<void> RunRefreshDependenciesLock(CoreParams params)
+    {
+        ghc::filesystem::path absoluteScriptPath;
+        ghc::filesystem::path scriptDirectory;
+        std::string scriptName;
+        std::unordered_map<std::string, std::string> parameters;
+        Data::ScriptInfo scriptInfo;
+        GetScriptInfoData(  params.scriptPath, 
+                            params.rawParameters, 
+                            
+                            //Output:
+                            scriptInfo,
+                            absoluteScriptPath,
+                            scriptDirectory,
+                            scriptName,
+                            parameters).DS_TRY();
+        
+        ghc::filesystem::path buildDir = GetDefaultBuildDir().DS_TRY();
+        BuildsManager buildsManager("/tmp");
+        IncludeManager includeManager;
+        InitializeBuildDirectory(   buildDir,
+                                    absoluteScriptPath,
+                                    params.buildLocally,
+                                    buildsManager,
+                                    buildDir,
+                                    includeManager).DS_TRY();
+        ResolveDependenciesImports(scriptInfo, scriptDirectory, buildDir, parameters).DS_TRY();
+        
+        std::vector<Data::DependencyInfo*> availableDependencies;
+        for(int i = 0; i < scriptInfo.Dependencies.size(); ++i)
+        {
+            if(IsDependencyAvailableForThisPlatform(scriptInfo.Dependencies.at(i)))
+                availableDependencies.push_back(&scriptInfo.Dependencies.at(i));
+        }
+        
+        std::vector<std::string> dependenciesLocalCopiesPaths;
+        std::vector<std::string> dependenciesSourcePaths;
+        GetDependenciesPaths(   availableDependencies,
+                                dependenciesLocalCopiesPaths,
+                                dependenciesSourcePaths,
+                                scriptDirectory,
+                                buildDir).DS_TRY();
+        
+        RefreshDependenciesLock(scriptInfo,
+                                availableDependencies,
+                                dependenciesLocalCopiesPaths,
+                                GetDependenciesLockPath(scriptDirectory, scriptName)).DS_TRY();
+        return {};
+    }
+    
+    //NOTE: hotReload needs to be the same as the one the script is run with, so that the script 
+    //      info is compared with the same build type.
+    //      sharedJobPool and sharedFilesCache are used instead of creating new ones if provided.
     inline DS::Result<bool> 
     CheckSourcesNeedUpdate( CoreParams params,
                             const std::string rawMaxThreads,
+                            const bool hotReload,
                             const Data::ScriptInfo* lastScriptInfo,
                             const ghc::filesystem::file_time_type& prevFinalSourceWriteTime,
-                            const ghc::filesystem::file_time_type& prevFinalIncludeWriteTime)
+                            const ghc::filesystem::file_time_type& prevFinalIncludeWriteTime,
+                            JobPool* sharedJobPool = nullptr,
+                            FilesCache* sharedFilesCache = nullptr)
     {
         ghc::filesystem::path absoluteScriptPath;
         ghc::filesystem::path scriptDirectory;
@@ -463,6 +526,10 @@ namespace runcpp2
                             scriptName,
                             parameters).DS_TRY();
         
+        //The script is loaded into runcpp2 as a shared library for hot reloading
+        if(hotReload)
+            scriptInfo.CurrentBuildType = Data::BuildType::SHARED;
+        
         //First check if script info file has changed
         {
             std::error_code e;
@@ -502,13 +569,27 @@ namespace runcpp2
                                     buildsManager,
                                     buildDir,
                                     includeManager).DS_TRY();
+        includeManager.SetFilesCache(sharedFilesCache);
         
-        const int maxThreads = rawMaxThreads.empty() ? 8 : strtol(  rawMaxThreads.c_str(), 
-                                                                    nullptr, 
-                                                                    10);
+        const int maxThreads =  rawMaxThreads.empty() ? 
+                                GetDefaultMaxThreads() : 
+                                strtol(rawMaxThreads.c_str(), nullptr, 10);
         if(maxThreads <= 0)
             return DS_ERROR_MSG("Invalid number of threads passed in");
         
+        //NOTE: The default number of threads changes with the system load, use the hardware 
+        //      threads for unity build instead so that the unity sources stay the same
+        const int unityThreads = rawMaxThreads.empty() ? GetHardwareThreadsCount() : maxThreads;
+        
+        std::unique_ptr<Jobserver> ownedJobserver;
+        std::unique_ptr<JobPool> ownedJobPool;
+        if(sharedJobPool == nullptr)
+        {
+            ownedJobserver.reset(new Jobserver());
+            ownedJobserver->Initialize(maxThreads);
+            ownedJobPool.reset(new JobPool(maxThreads, 0, ownedJobserver.get()));
+        }
+        JobPool& jobPool = sharedJobPool != nullptr ? *sharedJobPool : *ownedJobPool;
         ResolveDependenciesImports(scriptInfo, scriptDirectory, buildDir, parameters).DS_TRY();
         
         //Check if script info has changed if provided and run setup if needed
@@ -535,9 +616,10 @@ namespace runcpp2
                             params.profiles.at(profileIndex),
                             scriptDirectory,
                             buildDir,
+                            GetDependenciesLockPath(scriptDirectory, scriptName),
                             changedDependencies,
                             false,
-                            maxThreads,
+                            jobPool,
                             availableDependencies,
                             gatheredBinariesPaths).DS_TRY();
         
@@ -547,6 +629,12 @@ namespace runcpp2
                             scriptInfo, 
                             params.profiles.at(profileIndex), 
                             sourceFiles).DS_TRY();
+        GroupUnitySourceFiles(  absoluteScriptPath,
+                                scriptInfo,
+                                params.profiles.at(profileIndex),
+                                buildDir,
+                                unityThreads,
+                                sourceFiles).DS_TRY();
 
         //Check if we have already compiled before.
         std::vector<bool> sourceHasCache;
@@ -574,6 +662,103 @@ namespace runcpp2
             return false;
     }
 
+    //NOTE: Gets the paths that need to be watched for changes, which are the script, the script
+    //      info file, all the source files and their recorded includes, and the local dependencies
+    //      directories. The include records are only available after the script is built.
+    //      The include records are read from sharedFilesCache if provided.
+    inline DS::Result<void>
+    GetWatchPaths(  CoreParams params,
+                    const std::string rawMaxThreads,
+                    std::vector<ghc::filesystem::path>& outFilesPaths,
+                    std::vector<ghc::filesystem::path>& outDirectoriesPaths,
+                    FilesCache* sharedFilesCache = nullptr)
+    {
+        ssLOG_FUNC_INFO();
+        
+        ghc::filesystem::path absoluteScriptPath;
+        ghc::filesystem::path scriptDirectory;
+        std::string scriptName;
+        std::unordered_map<std::string, std::string> parameters;
+        Data::ScriptInfo scriptInfo;
+        
+        GetScriptInfoData(  params.scriptPath,
+                            params.rawParameters,
+                            
+                            //Output:
+                            scriptInfo,
+                            absoluteScriptPath,
+                            scriptDirectory,
+                            scriptName,
+                            parameters).DS_TRY();
+        
+        //NOTE: The dedicated script info file is watched even if it doesn't exist yet
+        outFilesPaths.push_back(absoluteScriptPath);
+        outFilesPaths.push_back(scriptDirectory / ghc::filesystem::path(scriptName + ".yaml"));
+        
+        for(int i = 0; i < scriptInfo.Dependencies.size(); ++i)
+        {
+            const Data::DependencySource& source = scriptInfo.Dependencies.at(i).Source;
+            const Data::LocalSource* local = mpark::get_if<Data::LocalSource>(&source.Source);
+            if(!local || !source.ImportPath.empty())
+                continue;
+            
+            if(ghc::filesystem::path(local->Path).is_relative())
+                outDirectoriesPaths.push_back(scriptDirectory / local->Path);
+            else
+                outDirectoriesPaths.push_back(local->Path);
+        }
+        
+        if(params.profiles.empty())
+            return DS_ERROR_MSG("No compiler profiles found");
+        
+        int profileIndex =  GetPreferredProfileIndex(   absoluteScriptPath,
+                                                        scriptInfo,
+                                                        params.profiles,
+                                                        params.configPreferredProfile).DS_TRY();
+        
+        ghc::filesystem::path buildDir = GetDefaultBuildDir().DS_TRY();
+        BuildsManager buildsManager("/tmp");
+        IncludeManager includeManager;
+        InitializeBuildDirectory(   buildDir,
+                                    absoluteScriptPath,
+                                    params.buildLocally,
+                                    buildsManager,
+                                    buildDir,
+                                    includeManager).DS_TRY();
+        includeManager.SetFilesCache(sharedFilesCache);
+        
+        std::vector<ghc::filesystem::path> sourceFiles;
+        GatherSourceFiles(  absoluteScriptPath,
+                            scriptInfo,
+                            params.profiles.at(profileIndex),
+                            sourceFiles).DS_TRY();
+        outFilesPaths.insert(outFilesPaths.end(), sourceFiles.begin(), sourceFiles.end());
+        
+        //The include records are stored for the unity sources if the sources are grouped
+        const int unityThreads =    rawMaxThreads.empty() ?
+                                    GetHardwareThreadsCount() :
+                                    strtol(rawMaxThreads.c_str(), nullptr, 10);
+        if(unityThreads <= 0)
+            return DS_ERROR_MSG("Invalid number of threads passed in");
+        
+        GroupUnitySourceFiles(  absoluteScriptPath,
+                                scriptInfo,
+                                params.profiles.at(profileIndex),
+                                buildDir,
+                                unityThreads,
+                                sourceFiles).DS_TRY();
+        
+        for(int i = 0; i < sourceFiles.size(); ++i)
+        {
+            std::vector<ghc::filesystem::path> includes;
+            ghc::filesystem::file_time_type recordTime;
+            if(includeManager.ReadIncludeRecord(sourceFiles.at(i), includes, recordTime))
+                outFilesPaths.insert(outFilesPaths.end(), includes.begin(), includes.end());
+        }
+        
+        return {};
+    }
+    
     struct RunParams
     {
         CoreParams Core;
@@ -581,16 +766,25 @@ namespace runcpp2
         bool compileOnly;
         bool buildSourceOnly;
         bool buildOnly;
+        bool failFast;
+        bool hotReload;
         const std::vector<std::string>& runArgs;
         const std::string rawMaxThreads;
+        const std::string rawMemoryLimit;
         const Data::ScriptInfo* lastScriptInfo;
         const ghc::filesystem::path& buildOutputDir;
+        
+        //Used instead of creating new ones if not null, such as when building multiple scripts
+        JobPool* sharedJobPool;
+        FilesCache* sharedFilesCache;
     };
 
+    //NOTE: outRunnableTarget is set to the built executable or shared library if provided
     inline DS::Result<int> Run( RunParams runParams,
                                 Data::ScriptInfo& outScriptInfo,
                                 ghc::filesystem::file_time_type& outFinalSourceWriteTime,
-                                ghc::filesystem::file_time_type& outFinalIncludeWriteTime)
+                                ghc::filesystem::file_time_type& outFinalIncludeWriteTime,
+                                ghc::filesystem::path* outRunnableTarget = nullptr)
     {
         ssLOG_FUNC_INFO();
         
@@ -611,6 +805,10 @@ namespace runcpp2
                             scriptName,
                             parameters).DS_TRY();
         
+        //The script is loaded into runcpp2 as a shared library for hot reloading
+        if(runParams.hotReload)
+            scriptInfo.CurrentBuildType = Data::BuildType::SHARED;
+        
         if(runParams.Core.profiles.empty())
             return DS_ERROR_MSG("No compiler profiles found");
         
@@ -631,13 +829,42 @@ namespace runcpp2
                                         buildsManager,
                                         buildDir,
                                         includeManager).DS_TRY();
+            includeManager.SetFilesCache(runParams.sharedFilesCache);
             
             const int maxThreads =  runParams.rawMaxThreads.empty() ? 
-                                    8 : 
+                                    GetDefaultMaxThreads() : 
                                     strtol(runParams.rawMaxThreads.c_str(), nullptr, 10);
             if(maxThreads <= 0)
                 return DS_ERROR_MSG("Invalid number of threads passed in");
             
+            //NOTE: The default number of threads changes with the system load, use the hardware 
+            //      threads for unity build instead so that the unity sources stay the same
+            const int unityThreads =    runParams.rawMaxThreads.empty() ? 
+                                        GetHardwareThreadsCount() : 
+                                        maxThreads;
+            
+            const int64_t memoryLimitMB =   runParams.rawMemoryLimit.empty() ? 
+                                            0 : 
+                                            strtoll(runParams.rawMemoryLimit.c_str(), nullptr, 10);
+            if(memoryLimitMB < 0 || (!runParams.rawMemoryLimit.empty() && memoryLimitMB == 0))
+                return DS_ERROR_MSG("Invalid memory limit passed in");
+            
+            //Shared by dependencies setup/build and compilation. The jobserver is also passed 
+            //down to the dependencies setup and build commands so that they share the same jobs 
+            //limit.
+            std::unique_ptr<Jobserver> ownedJobserver;
+            std::unique_ptr<JobPool> ownedJobPool;
+            if(runParams.sharedJobPool == nullptr)
+            {
+                ownedJobserver.reset(new Jobserver());
+                ownedJobserver->Initialize(maxThreads);
+                ownedJobPool.reset(new JobPool( maxThreads, 
+                                                memoryLimitMB * 1024, 
+                                                ownedJobserver.get()));
+            }
+            JobPool& jobPool =  runParams.sharedJobPool != nullptr ? 
+                                *runParams.sharedJobPool : 
+                                *ownedJobPool;
             ResolveDependenciesImports(scriptInfo, scriptDirectory, buildDir, parameters).DS_TRY();
             
             //Check if script info has changed if provided and run setup if needed
@@ -657,17 +884,47 @@ namespace runcpp2
             
             std::vector<std::string> gatheredBinariesPaths;
             
-            //Process Dependencies
+            //Populate and setup dependencies, which is all we need for compiling the sources
             std::vector<Data::DependencyInfo*> availableDependencies;
-            ProcessDependencies(scriptInfo,
+            std::vector<std::string> dependenciesLocalCopiesPaths;
+            std::vector<bool> dependenciesReady;
+            std::vector<Data::DependencyReadyRecord> dependenciesRecords;
+            PrepareDependencies(scriptInfo,
                                 runParams.Core.profiles.at(profileIndex),
                                 scriptDirectory,
                                 buildDir,
+                                GetDependenciesLockPath(scriptDirectory, scriptName),
                                 changedDependencies,
                                 runParams.buildSourceOnly,
-                                maxThreads,
+                                jobPool,
                                 availableDependencies,
-                                gatheredBinariesPaths).DS_TRY();
+                                dependenciesLocalCopiesPaths,
+                                dependenciesReady,
+                                dependenciesRecords).DS_TRY();
+            
+            //Build the dependencies in the background while the sources are being compiled.
+            //Only linking and the sources using the dependencies being built need to wait for them.
+            //NOTE: The future waits for the build when it goes out of scope, so any early returns 
+            //      are still safe.
+            const Data::Profile& currentProfile = runParams.Core.profiles.at(profileIndex);
+            const bool buildSourceOnly = runParams.buildSourceOnly;
+            std::future<DS::Result<void>> dependenciesBuild = std::async
+            (
+                std::launch::async,
+                [&]()
+                {
+                    return BuildAndGatherDependencies(  scriptInfo,
+                                                        currentProfile,
+                                                        buildDir,
+                                                        availableDependencies,
+                                                        dependenciesLocalCopiesPaths,
+                                                        dependenciesReady,
+                                                        dependenciesRecords,
+                                                        buildSourceOnly,
+                                                        jobPool,
+                                                        gatheredBinariesPaths);
+                }
+            );
             
             //Get all the files we are trying to compile
             std::vector<ghc::filesystem::path> sourceFiles;
@@ -675,6 +932,12 @@ namespace runcpp2
                                 scriptInfo, 
                                 runParams.Core.profiles.at(profileIndex), 
                                 sourceFiles).DS_TRY();
+            GroupUnitySourceFiles(  absoluteScriptPath,
+                                    scriptInfo,
+                                    runParams.Core.profiles.at(profileIndex),
+                                    buildDir,
+                                    unityThreads,
+                                    sourceFiles).DS_TRY();
 
             //Get all include paths
             std::vector<ghc::filesystem::path> sourceIncludePaths;
@@ -706,7 +969,86 @@ namespace runcpp2
                                     outFinalIncludeWriteTime).DS_TRY();
             }
             
+            std::vector<ghc::filesystem::path> depLinkFilesPaths;
+            std::vector<int> depBinaryFilesPriorities;
+            std::vector<std::string> depRPathDirectories;
+            ghc::filesystem::file_time_type finalBinaryWriteTime = finalObjectWriteTime;
+            bool dependenciesWaited = false;
+            auto waitForDependencies = [&]() -> DS::Result<void>
+            {
+                if(dependenciesWaited)
+                    return {};
+                
+                dependenciesWaited = true;
+                DS::Result<void> buildResult = dependenciesBuild.get();
+                ssLOG_OUTPUT_ALL_CACHE_GROUPED();
+                buildResult.DS_TRY();
+                
+                SeparateDependencyFiles(currentProfile.FilesTypes, 
+                                        gatheredBinariesPaths, 
+                                        depLinkFilesPaths, 
+                                        filesToCopyPaths);
+                
+                //Load the shared dependencies from where they are instead of copying them, unless 
+                //the output is going to a separate directory which needs to be relocatable
+                if( scriptInfo.SharedDependenciesRPath && 
+                    runcpp2::HasValueFromPlatformMap(currentProfile.Linker.RPathFlag))
+                {
+                    SeparateRPathDependencyFiles(   currentProfile,
+                                                    availableDependencies,
+                                                    dependenciesLocalCopiesPaths,
+                                                    depLinkFilesPaths,
+                                                    !runParams.buildOutputDir.empty(),
+                                                    filesToCopyPaths,
+                                                    depRPathDirectories);
+                }
+                
+                //TODO: Allow user to pass the priorities outside
+                //Set dependencies files to be lower priority
+                for(int i = 0; i < depLinkFilesPaths.size(); ++i)
+                    depBinaryFilesPriorities.push_back(-100);
+                
+                //Get finalBinaryWriteTime by combining final object and dependencies write times
+                std::error_code e;
+                for(int i = 0; i < depLinkFilesPaths.size(); ++i)
+                {
+                    if(!ghc::filesystem::exists(depLinkFilesPaths.at(i), e))
+                    {
+                        return DS_ERROR_MSG(depLinkFilesPaths.at(i).string() + 
+                                            " reported as cached but doesn't exist");
+                    }
+                    
+                    ghc::filesystem::file_time_type lastWriteTime = 
+                        ghc::filesystem::last_write_time(depLinkFilesPaths.at(i), e);
+                    
+                    if(lastWriteTime > finalBinaryWriteTime)
+                        finalBinaryWriteTime = lastWriteTime;
+                }
+                
+                return {};
+            };
+            
+            //The dependency include paths used by each source are only known after the 
+            //dependencies are built, since building them can generate headers
+            if(scriptInfo.PruneDependencyIncludePaths)
+                waitForDependencies().DS_TRY();
+            
+            //Include paths of the dependencies that are built in the background
+            std::vector<ghc::filesystem::path> pendingDepIncludePaths;
+            for(int i = 0; i < availableDependencies.size() && !dependenciesWaited; ++i)
+            {
+                if(dependenciesReady.at(i))
+                    continue;
+                
+                const std::vector<std::string>& currentIncludePaths = 
+                    availableDependencies.at(i)->AbsoluteIncludePaths;
+                pendingDepIncludePaths.insert(  pendingDepIncludePaths.end(), 
+                                                currentIncludePaths.begin(), 
+                                                currentIncludePaths.end());
+            }
+            
             runcpp2::SourceIncludeMap sourceIncludeMap;
+            runcpp2::SourceIncludeMap sourceIncludePathsUsed;
             {
                 std::vector<ghc::filesystem::path> allIncludePaths = sourceIncludePaths;
                 allIncludePaths.insert( allIncludePaths.end(), 
@@ -715,7 +1057,72 @@ namespace runcpp2
                 runcpp2::GatherFilesIncludes(   sourceFiles, 
                                                 sourceHasCache, 
                                                 allIncludePaths, 
-                                                sourceIncludeMap).DS_TRY();
+                                                !pendingDepIncludePaths.empty(),
+                                                sourceIncludeMap,
+                                                sourceIncludePathsUsed).DS_TRY();
+            }
+            
+            //Only pass the dependency include paths used by each source if we are pruning them.
+            //Sources not in sourcesDepIncludePaths are compiled with all of them.
+            runcpp2::SourceIncludeMap sourcesDepIncludePaths;
+            if(scriptInfo.PruneDependencyIncludePaths)
+            {
+                for(auto it = sourceIncludePathsUsed.begin(); 
+                    it != sourceIncludePathsUsed.end(); 
+                    ++it)
+                {
+                    const std::vector<ghc::filesystem::path>& usedPaths = it->second;
+                    std::vector<ghc::filesystem::path>& currentDepIncludePaths = 
+                        sourcesDepIncludePaths[it->first];
+                    for(int i = 0; i < depIncludePaths.size(); ++i)
+                    {
+                        const ghc::filesystem::path& depIncludePath = depIncludePaths.at(i);
+                        if(std::find(usedPaths.begin(), usedPaths.end(), depIncludePath) != 
+                           usedPaths.end())
+                        {
+                            currentDepIncludePaths.push_back(depIncludePath);
+                        }
+                    }
+                    
+                    ssLOG_DEBUG("Using " << currentDepIncludePaths.size() << " out of " << 
+                                depIncludePaths.size() << " dependency include paths for " << 
+                                it->first);
+                }
+            }
+            
+            //Sources can be compiled while the dependencies are being built only if none of their 
+            //includes are from, or could be generated in, the dependencies still being built.
+            //The rest are compiled after the dependencies are built.
+            std::unordered_set<std::string> sourcesReadyToCompile;
+            for(int i = 0; i < sourceFiles.size(); ++i)
+            {
+                const std::string currentSource = sourceFiles.at(i).string();
+                if(pendingDepIncludePaths.empty())
+                {
+                    sourcesReadyToCompile.insert(currentSource);
+                    continue;
+                }
+                
+                if(sourceIncludePathsUsed.count(currentSource) == 0)
+                    continue;
+                
+                const std::vector<ghc::filesystem::path>& usedPaths = 
+                    sourceIncludePathsUsed.at(currentSource);
+                bool usesPendingDependency = false;
+                for(int j = 0; j < usedPaths.size() && !usesPendingDependency; ++j)
+                {
+                    usesPendingDependency = std::find(  pendingDepIncludePaths.begin(), 
+                                                        pendingDepIncludePaths.end(), 
+                                                        usedPaths.at(j)) != 
+                                            pendingDepIncludePaths.end();
+                }
+                
+                if(usesPendingDependency)
+                {
+                    ssLOG_DEBUG(currentSource << " waits for the dependencies to be built");
+                    continue;
+                }
+                sourcesReadyToCompile.insert(currentSource);
             }
             for(int i = 0; i < sourceFiles.size(); ++i)
             {
@@ -746,34 +1153,18 @@ namespace runcpp2
                 }
             }
             
-            std::vector<ghc::filesystem::path> depLinkFilesPaths;
-            SeparateDependencyFiles(runParams.Core.profiles.at(profileIndex).FilesTypes, 
-                                    gatheredBinariesPaths, 
-                                    depLinkFilesPaths, 
-                                    filesToCopyPaths);
+            //Output cache can only be used when all sources are cached, which needs the 
+            //dependencies binaries to be checked as well. Otherwise we can compile straight away.
+            bool allSourcesCached = true;
+            for(int i = 0; i < sourceHasCache.size(); ++i)
+                allSourcesCached = allSourcesCached && sourceHasCache.at(i);
             
-            //TODO: Allow user to pass the priorities outside
-            //Set dependencies files to be lower priority
-            std::vector<int> depBinaryFilesPriorities;
-            for(int i = 0; i < depLinkFilesPaths.size(); ++i)
-                depBinaryFilesPriorities.push_back(-100);
-            
-            //Get finalBinaryWriteTime by combining final object and dependencies write times
-            std::error_code e;
-            ghc::filesystem::file_time_type finalBinaryWriteTime = finalObjectWriteTime;
-            for(int i = 0; i < depLinkFilesPaths.size(); ++i)
+            //PreBuild commands can use the outputs of the dependencies, so only compile while the 
+            //dependencies are building if there are no PreBuild commands
+            if( allSourcesCached || 
+                HasPreBuildCommands(scriptInfo, runParams.Core.profiles.at(profileIndex)))
             {
-                if(!ghc::filesystem::exists(depLinkFilesPaths.at(i), e))
-                {
-                    return DS_ERROR_MSG(depLinkFilesPaths.at(i).string() + 
-                                        " reported as cached but doesn't exist");
-                }
-                
-                ghc::filesystem::file_time_type lastWriteTime = 
-                    ghc::filesystem::last_write_time(depLinkFilesPaths.at(i), e);
-
-                if(lastWriteTime > finalBinaryWriteTime)
-                    finalBinaryWriteTime = lastWriteTime;
+                waitForDependencies().DS_TRY();
             }
             
             //Run PreBuild commands before compilation
@@ -812,9 +1203,14 @@ namespace runcpp2
                                         sourceHasCache,
                                         sourceIncludePaths, 
                                         depIncludePaths, 
+                                        sourcesDepIncludePaths,
+                                        sourcesReadyToCompile,
+                                        waitForDependencies,
                                         scriptInfo,
                                         runParams.Core.profiles.at(profileIndex),
-                                        maxThreads).DS_TRY();
+                                        jobPool,
+                                        runParams.failFast).DS_TRY();
+                    waitForDependencies().DS_TRY();
                     return 0;
                 }
                 else
@@ -826,6 +1222,8 @@ namespace runcpp2
                                             sourceHasCache,
                                             sourceIncludePaths, 
                                             depIncludePaths, 
+                                            sourcesDepIncludePaths,
+                                            sourcesReadyToCompile,
                                             scriptInfo,
                                             availableDependencies,
                                             runParams.Core.profiles.at(profileIndex),
@@ -833,12 +1231,18 @@ namespace runcpp2
                                             depBinaryFilesPriorities,
                                             sourceLinkFilesPaths,
                                             sourceBinaryFilesPriorities,
-                                            maxThreads)
+                                            depRPathDirectories,
+                                            waitForDependencies,
+                                            jobPool,
+                                            runParams.failFast)
                         .DS_TRY_ACT(DS_TMP_ERROR.Message += "\nFailed to compile or link script.";
                                     DS_APPEND_TRACE(DS_TMP_ERROR);
                                     return DS::Error(DS_TMP_ERROR));
                 }
             }
+            
+            //Make sure the dependencies binaries are gathered for copying
+            waitForDependencies().DS_TRY();
         }
         
         //Trigger post build and run the script if needed
@@ -887,6 +1291,9 @@ namespace runcpp2
                             runParams.Core.profiles.at(profileIndex), 
                             buildDir.string()).DS_TRY();
             
+            if(outRunnableTarget)
+                *outRunnableTarget = runnableTarget;
+            
             //Don't run if we are just watching or building
             if(runParams.buildOnly)
                 return 0;